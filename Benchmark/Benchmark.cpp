@@ -0,0 +1,87 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+// Times Game::simulatePhysics on the host.
+//
+// Usage: benchmark [steps]
+//
+// Each run starts from the same seed, so results are comparable between builds.
+// Prints one line per scene: objects, scene, steps, nanoseconds per step.
+
+#include "Game.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	constexpr unsigned long defaultSteps = 100000;
+	constexpr unsigned long warmupSteps = 600;
+
+	// Presses and then releases the specified buttons
+	void tapButtons(Game & game, uint8_t buttons)
+	{
+		stubSetButtons(buttons);
+		Arduboy2::pollButtons();
+		game.updateInput();
+
+		stubSetButtons(0);
+		Arduboy2::pollButtons();
+		game.updateInput();
+	}
+
+	double measure(Game & game, unsigned long steps)
+	{
+		for(unsigned long step = 0; step < warmupSteps; ++step)
+			game.simulatePhysics();
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for(unsigned long step = 0; step < steps; ++step)
+			game.simulatePhysics();
+
+		const auto end = std::chrono::steady_clock::now();
+
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+		return (static_cast<double>(elapsed) / steps);
+	}
+
+	void run(const char * scene, bool gravity, unsigned long steps)
+	{
+		Game game;
+		game.setup();
+
+		// B + Down toggles gravity.
+		if(gravity)
+			tapButtons(game, B_BUTTON | DOWN_BUTTON);
+
+		const double nanoseconds = measure(game, steps);
+
+		std::printf("%3u objects  %-8s %8lu steps  %10.1f ns/step\n", static_cast<unsigned>(Game::objectCount), scene, steps, nanoseconds);
+	}
+}
+
+int main(int argumentCount, char * arguments[])
+{
+	const unsigned long steps = (argumentCount > 1) ? std::strtoul(arguments[1], nullptr, 10) : defaultSteps;
+
+	run("floating", false, steps);
+	run("gravity", true, steps);
+
+	return 0;
+}
\ No newline at end of file
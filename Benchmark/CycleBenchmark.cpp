@@ -0,0 +1,135 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+// Counts the ATmega32u4 cycles taken by Game::simulatePhysics, under simavr.
+//
+// Timer1 runs from the undivided CPU clock, so it counts cycles directly,
+// and its overflows are counted to extend it to 32 bits.
+// Results are written to simavr's console register, so they appear in simavr's output.
+
+#include "Game.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#include <avr_mcu_section.h>
+
+AVR_MCU(F_CPU, "atmega32u4");
+AVR_MCU_SIMAVR_CONSOLE(&GPIOR0);
+
+namespace
+{
+	constexpr uint16_t warmupSteps = 60;
+	constexpr uint16_t measuredSteps = 240;
+
+	volatile uint16_t timerOverflows = 0;
+
+	uint32_t readCycles()
+	{
+		const uint8_t status = SREG;
+		cli();
+
+		const uint16_t count = TCNT1;
+		uint16_t overflows = timerOverflows;
+
+		// Account for an overflow that hasn't been serviced yet.
+		if(((TIFR1 & (1 << TOV1)) != 0) && (count < 0x8000))
+			++overflows;
+
+		SREG = status;
+
+		return ((static_cast<uint32_t>(overflows) << 16) | count);
+	}
+
+	void printText(const char * text)
+	{
+		while(*text != '\0')
+			GPIOR0 = *text++;
+	}
+
+	void printNumber(uint32_t value)
+	{
+		char digits[11];
+		uint8_t index = sizeof(digits);
+
+		digits[--index] = '\0';
+
+		do
+		{
+			digits[--index] = static_cast<char>('0' + (value % 10));
+			value /= 10;
+		}
+		while(value != 0);
+
+		printText(&digits[index]);
+	}
+
+	void measure(Game & game, const char * scene)
+	{
+		for(uint16_t step = 0; step < warmupSteps; ++step)
+			game.simulatePhysics();
+
+		const uint32_t start = readCycles();
+
+		for(uint16_t step = 0; step < measuredSteps; ++step)
+			game.simulatePhysics();
+
+		const uint32_t end = readCycles();
+
+		printNumber(Game::objectCount);
+		printText(" objects ");
+		printText(scene);
+		printText(": ");
+		printNumber((end - start) / measuredSteps);
+		printText(" cycles/step\n");
+	}
+}
+
+ISR(TIMER1_OVF_vect)
+{
+	++timerOverflows;
+}
+
+Game game;
+
+int main()
+{
+	// Start Timer1 with no prescaler.
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+	TIMSK1 = (1 << TOIE1);
+	sei();
+
+	game.setup();
+	measure(game, "floating");
+
+	// B + Down toggles gravity.
+	stubSetButtons(B_BUTTON | DOWN_BUTTON);
+	Arduboy2::pollButtons();
+	game.updateInput();
+
+	stubSetButtons(0);
+	Arduboy2::pollButtons();
+	game.updateInput();
+	measure(game, "gravity");
+
+	// Sleeping with interrupts disabled ends the simulation.
+	cli();
+	sleep_cpu();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#include "Arduboy2.h"
+#include "EEPROM.h"
+
+#if !defined(__AVR__)
+#include <chrono>
+#endif
+
+uint8_t Arduboy2Base::sBuffer[(WIDTH * HEIGHT) / 8];
+
+uint8_t Arduboy2Base::currentButtonState = 0;
+uint8_t Arduboy2Base::previousButtonState = 0;
+
+SerialStub Serial;
+EEPROMClass EEPROM;
+
+namespace
+{
+	uint8_t stubButtons = 0;
+}
+
+void stubSetButtons(uint8_t buttons)
+{
+	stubButtons = buttons;
+}
+
+uint8_t Arduboy2Core::buttonsState()
+{
+	return stubButtons;
+}
+
+#if !defined(__AVR__)
+unsigned long micros()
+{
+	using namespace std::chrono;
+
+	static const auto start = steady_clock::now();
+
+	return static_cast<unsigned long>(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+
+unsigned long millis()
+{
+	return (micros() / 1000);
+}
+#else
+// The cycle benchmark measures time with a hardware timer instead.
+unsigned long micros()
+{
+	return 0;
+}
+
+unsigned long millis()
+{
+	return 0;
+}
+#endif
\ No newline at end of file
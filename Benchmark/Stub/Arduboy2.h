@@ -0,0 +1,221 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+// A stand-in for the parts of the Arduino and Arduboy2 APIs that Game.h uses,
+// so that the game can be built without the hardware.
+//
+// Drawing and printing do nothing, EEPROM is an array in memory,
+// and the buttons are whatever `stubSetButtons` was last given,
+// so the simulation can be driven headlessly.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Arduino
+//
+
+#if !defined(__AVR__)
+#define PROGMEM
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t *>(address))
+#define pgm_read_word(address) (*reinterpret_cast<const uint16_t *>(address))
+#define pgm_read_ptr(address) (*reinterpret_cast<const void * const *>(address))
+#else
+#include <avr/pgmspace.h>
+#endif
+
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper *>(string))
+
+inline long random(long maximum)
+{
+	return (maximum > 0) ? static_cast<long>(rand() % maximum) : 0;
+}
+
+inline long random(long minimum, long maximum)
+{
+	return (maximum > minimum) ? (minimum + random(maximum - minimum)) : minimum;
+}
+
+inline void randomSeed(unsigned long seed)
+{
+	srand(static_cast<unsigned int>(seed));
+}
+
+unsigned long millis();
+unsigned long micros();
+
+#define DEC 10
+#define HEX 16
+
+class Print
+{
+public:
+	virtual ~Print() = default;
+
+	virtual size_t write(uint8_t)
+	{
+		return 1;
+	}
+
+	virtual int availableForWrite()
+	{
+		return 0;
+	}
+
+	size_t write(const uint8_t * buffer, size_t size)
+	{
+		for(size_t index = 0; index < size; ++index)
+			this->write(buffer[index]);
+
+		return size;
+	}
+
+	size_t print(const __FlashStringHelper *) { return 0; }
+	size_t print(const char *) { return 0; }
+	size_t print(char) { return 0; }
+	size_t print(int, int = 10) { return 0; }
+	size_t print(unsigned int, int = 10) { return 0; }
+	size_t print(long, int = 10) { return 0; }
+	size_t print(unsigned long, int = 10) { return 0; }
+	size_t print(double, int = 2) { return 0; }
+
+	size_t println() { return 0; }
+	size_t println(const __FlashStringHelper *) { return 0; }
+	size_t println(const char *) { return 0; }
+	size_t println(char) { return 0; }
+	size_t println(int, int = 10) { return 0; }
+	size_t println(unsigned int, int = 10) { return 0; }
+	size_t println(long, int = 10) { return 0; }
+	size_t println(unsigned long, int = 10) { return 0; }
+	size_t println(double, int = 2) { return 0; }
+};
+
+class SerialStub : public Print
+{
+public:
+	void begin(unsigned long) {}
+
+	int availableForWrite() override
+	{
+		return 64;
+	}
+
+	explicit operator bool() const
+	{
+		return true;
+	}
+};
+
+extern SerialStub Serial;
+
+//
+// Arduboy2
+//
+
+#define LEFT_BUTTON (1 << 5)
+#define RIGHT_BUTTON (1 << 6)
+#define UP_BUTTON (1 << 7)
+#define DOWN_BUTTON (1 << 4)
+#define A_BUTTON (1 << 3)
+#define B_BUTTON (1 << 2)
+
+#define WIDTH 128
+#define HEIGHT 64
+
+#define WHITE 1
+#define BLACK 0
+
+#define EEPROM_STORAGE_SPACE_START 16
+
+/// Sets the state of the stub buttons, as returned by `buttonsState()`.
+void stubSetButtons(uint8_t buttons);
+
+class Arduboy2Core
+{
+public:
+	static constexpr uint8_t width() { return WIDTH; }
+	static constexpr uint8_t height() { return HEIGHT; }
+
+	static uint8_t buttonsState();
+
+	static void LCDDataMode() {}
+	static void LCDCommandMode() {}
+	static void SPItransfer(uint8_t) {}
+	static void sendLCDCommand(uint8_t) {}
+	static void paintScreen(const uint8_t *, bool = false) {}
+};
+
+class Arduboy2Base : public Arduboy2Core
+{
+public:
+	static uint8_t sBuffer[(WIDTH * HEIGHT) / 8];
+
+	void begin() {}
+	void setFrameRate(uint8_t) {}
+	bool nextFrame() { return true; }
+	int cpuLoad() { return 0; }
+
+	static uint8_t * getBuffer() { return sBuffer; }
+
+	static unsigned long generateRandomSeed() { return 1; }
+
+	// These are static so that the benchmarks can poll the buttons
+	// without access to the game's instance.
+	static uint8_t currentButtonState;
+	static uint8_t previousButtonState;
+
+	static void pollButtons()
+	{
+		previousButtonState = currentButtonState;
+		currentButtonState = buttonsState();
+	}
+
+	bool pressed(uint8_t buttons) const
+	{
+		return ((currentButtonState & buttons) == buttons);
+	}
+
+	bool justPressed(uint8_t button) const
+	{
+		return (((previousButtonState & button) == 0) && ((currentButtonState & button) != 0));
+	}
+
+	bool justReleased(uint8_t button) const
+	{
+		return (((previousButtonState & button) != 0) && ((currentButtonState & button) == 0));
+	}
+
+	void clear() {}
+	void display() {}
+
+	static void drawPixel(int16_t, int16_t, uint8_t = WHITE) {}
+	void fillRect(int16_t, int16_t, uint8_t, uint8_t, uint8_t = WHITE) {}
+	void drawRect(int16_t, int16_t, uint8_t, uint8_t, uint8_t = WHITE) {}
+	void drawCircle(int16_t, int16_t, uint8_t, uint8_t = WHITE) {}
+};
+
+class Arduboy2 : public Print, public Arduboy2Base
+{
+public:
+	void setCursor(int16_t, int16_t) {}
+
+	using Print::write;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+// A stand-in for the Arduino EEPROM library, backed by an array in memory.
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+class EEPROMClass
+{
+private:
+	uint8_t data[1024] {};
+
+public:
+	uint8_t read(int address) const
+	{
+		return data[address];
+	}
+
+	void write(int address, uint8_t value)
+	{
+		data[address] = value;
+	}
+
+	void update(int address, uint8_t value)
+	{
+		data[address] = value;
+	}
+
+	uint16_t length() const
+	{
+		return sizeof(data);
+	}
+
+	template< typename Type >
+	Type & get(int address, Type & value) const
+	{
+		memcpy(&value, &data[address], sizeof(Type));
+		return value;
+	}
+
+	template< typename Type >
+	const Type & put(int address, const Type & value)
+	{
+		memcpy(&data[address], &value, sizeof(Type));
+		return value;
+	}
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,188 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <Arduboy2.h>
+
+/// Tracks which parts of the frame buffer have changed.
+///
+/// The frame buffer is organised as pages:
+/// each byte is a column of eight vertical pixels,
+/// and each page is a row of those bytes spanning the width of the screen.
+/// The changed part of each page is kept as a single span of columns,
+/// which is also the smallest unit the display can be sent.
+template< uint8_t widthValue = WIDTH, uint8_t heightValue = HEIGHT >
+class DirtyRegion
+{
+public:
+	static constexpr uint8_t width = widthValue;
+	static constexpr uint8_t height = heightValue;
+	static constexpr uint8_t pageHeight = 8;
+	static constexpr uint8_t pageCount = (height / pageHeight);
+
+	static_assert((height % pageHeight) == 0, "The height must be a whole number of pages");
+
+private:
+	// SSD1306 commands
+	static constexpr uint8_t setColumnAddress = 0x21;
+	static constexpr uint8_t setPageAddress = 0x22;
+
+private:
+	// The first changed column of each page, inclusive.
+	uint8_t lefts[pageCount];
+
+	// The last changed column of each page, exclusive.
+	uint8_t rights[pageCount];
+
+public:
+	DirtyRegion()
+	{
+		this->clear();
+	}
+
+	/// Marks the whole region as unchanged.
+	void clear()
+	{
+		for(uint8_t page = 0; page < pageCount; ++page)
+		{
+			this->lefts[page] = width;
+			this->rights[page] = 0;
+		}
+	}
+
+	/// Indicates whether nothing has changed.
+	bool isEmpty() const
+	{
+		for(uint8_t page = 0; page < pageCount; ++page)
+			if(this->lefts[page] < this->rights[page])
+				return false;
+
+		return true;
+	}
+
+	/// Marks the specified rectangle as changed.
+	///
+	/// Parts of the rectangle that are off screen are ignored.
+	void include(int16_t x, int16_t y, uint8_t rectangleWidth, uint8_t rectangleHeight)
+	{
+		uint8_t left;
+		uint8_t right;
+		uint8_t firstPage;
+		uint8_t lastPage;
+
+		if(!clip(x, y, rectangleWidth, rectangleHeight, left, right, firstPage, lastPage))
+			return;
+
+		for(uint8_t page = firstPage; page <= lastPage; ++page)
+		{
+			if(left < this->lefts[page])
+				this->lefts[page] = left;
+
+			if(right > this->rights[page])
+				this->rights[page] = right;
+		}
+	}
+
+	/// Indicates whether any part of the specified rectangle has been marked as changed.
+	bool overlaps(int16_t x, int16_t y, uint8_t rectangleWidth, uint8_t rectangleHeight) const
+	{
+		uint8_t left;
+		uint8_t right;
+		uint8_t firstPage;
+		uint8_t lastPage;
+
+		if(!clip(x, y, rectangleWidth, rectangleHeight, left, right, firstPage, lastPage))
+			return false;
+
+		for(uint8_t page = firstPage; page <= lastPage; ++page)
+			if((left < this->rights[page]) && (right > this->lefts[page]))
+				return true;
+
+		return false;
+	}
+
+	/// Clears the changed parts of the specified frame buffer.
+	void erase(uint8_t * buffer) const
+	{
+		for(uint8_t page = 0; page < pageCount; ++page, buffer += width)
+			if(this->lefts[page] < this->rights[page])
+				memset(&buffer[this->lefts[page]], 0, this->rights[page] - this->lefts[page]);
+	}
+
+	/// Sends the changed parts of the specified frame buffer to the display.
+	///
+	/// Each changed page is sent by narrowing the display's address window to its span,
+	/// and the window is restored afterwards so that `Arduboy2::display` still works.
+	void display(const uint8_t * buffer) const
+	{
+		bool windowChanged = false;
+
+		for(uint8_t page = 0; page < pageCount; ++page, buffer += width)
+		{
+			const uint8_t left = this->lefts[page];
+			const uint8_t right = this->rights[page];
+
+			if(left >= right)
+				continue;
+
+			setWindow(left, (right - 1), page, page);
+			windowChanged = true;
+
+			for(uint8_t column = left; column < right; ++column)
+				Arduboy2Core::SPItransfer(buffer[column]);
+		}
+
+		if(windowChanged)
+			setWindow(0, (width - 1), 0, (pageCount - 1));
+	}
+
+private:
+	// Converts a rectangle to a span of columns and pages that are on screen.
+	// Returns false if none of the rectangle is on screen.
+	static bool clip(int16_t x, int16_t y, uint8_t rectangleWidth, uint8_t rectangleHeight, uint8_t & left, uint8_t & right, uint8_t & firstPage, uint8_t & lastPage)
+	{
+		const int16_t top = (y > 0) ? y : 0;
+		const int16_t bottom = ((y + rectangleHeight) < height) ? (y + rectangleHeight) : height;
+		const int16_t start = (x > 0) ? x : 0;
+		const int16_t end = ((x + rectangleWidth) < width) ? (x + rectangleWidth) : width;
+
+		if((top >= bottom) || (start >= end))
+			return false;
+
+		left = static_cast<uint8_t>(start);
+		right = static_cast<uint8_t>(end);
+		firstPage = static_cast<uint8_t>(top / pageHeight);
+		lastPage = static_cast<uint8_t>((bottom - 1) / pageHeight);
+
+		return true;
+	}
+
+	// Sets the area of the display that the following data will be written to.
+	static void setWindow(uint8_t left, uint8_t right, uint8_t top, uint8_t bottom)
+	{
+		Arduboy2Core::LCDCommandMode();
+		Arduboy2Core::SPItransfer(setColumnAddress);
+		Arduboy2Core::SPItransfer(left);
+		Arduboy2Core::SPItransfer(right);
+		Arduboy2Core::SPItransfer(setPageAddress);
+		Arduboy2Core::SPItransfer(top);
+		Arduboy2Core::SPItransfer(bottom);
+		Arduboy2Core::LCDDataMode();
+	}
+};
\ No newline at end of file
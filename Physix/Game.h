@@ -17,13 +17,75 @@
 #pragma once
 
 #include "Physics.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "DirtyRegion.h"
+#include "SpriteBlitter.h"
+#include "Sprites.h"
+#include "Scene.h"
+#include "Scenes.h"
+#include "Save.h"
+#include "Telemetry.h"
+#include "Particles.h"
 
 #include <Arduboy2.h>
 
+// The benchmarks define this to simulate different numbers of objects.
+#if !defined(PHYSIX_OBJECT_COUNT)
+#define PHYSIX_OBJECT_COUNT 8
+#endif
+
+// The benchmarks define this to compare the number types used by the physics world.
+#if !defined(PHYSIX_PRECISION)
+#define PHYSIX_PRECISION DefaultPrecision
+#endif
+
+// The benchmarks define this to simulate a scene instead of randomly placed objects.
+#if !defined(PHYSIX_SCENE)
+#define PHYSIX_SCENE noScene
+#endif
+
+// The benchmarks define this to simulate a world larger than the screen.
+#if !defined(PHYSIX_WORLD)
+#define PHYSIX_WORLD screenBounds
+#endif
+
+// The benchmarks define this to build the profiler in.
+#if !defined(PHYSIX_PROFILER)
+#define PHYSIX_PROFILER 0
+#endif
+
 class Game
 {
 
 public:
+	/// Indicates whether input should be recorded, played back, or neither.
+	///
+	/// To compare two builds on the same workload,
+	/// make a recording with `ReplayMode::Record`,
+	/// then build both with `ReplayMode::Playback`.
+	/// The recording is kept in EEPROM,
+	/// and the playback build also prints it over serial at start up.
+	static constexpr ReplayMode replayMode = ReplayMode::Off;
+
+	/// Indicates whether the state of the world should be streamed over serial.
+	///
+	/// Every frame sends the position, velocity and sleep state of up to eight objects,
+	/// taking turns when there are more,
+	/// along with the time of the frame and of each stage, and the number of contacts.
+	/// Frames that can't be sent in time are dropped rather than waited for.
+	/// (The times come from the profiler, which telemetry builds in.)
+	/// Tools/telemetry.py decodes and plots the stream.
+	static constexpr bool telemetryEnabled = false;
+
+	/// Indicates whether the profiler should be included.
+	///
+	/// Timing each stage costs a little every frame,
+	/// so the profiler is only included when something needs the times:
+	/// the benchmarks, playing back a recording to compare builds, and telemetry.
+	/// Otherwise the profiler and its diagnostic page are removed entirely.
+	static constexpr bool profilerEnabled = ((PHYSIX_PROFILER != 0) || (replayMode == ReplayMode::Playback) || telemetryEnabled);
+
 	/// Used for simulating friction.
 	///
 	/// Note: this is not how a real coefficient of friction works.
@@ -44,31 +106,312 @@ public:
 	/// A threshold to ensure the bouncing stops at some point.
 	static constexpr Number restitutionThreshold = (Number::Epsilon * 16);
 
+	/// The coefficient of friction as a constant factor,
+	/// which is applied with shifts and additions rather than multiplication.
+	using FrictionFactor = ConstantFactor<getFactorNumerator(coefficientOfFriction)>;
+
+	/// The coefficient of restitution as a constant factor.
+	using RestitutionFactor = ConstantFactor<getFactorNumerator(coefficientOfRestitution)>;
+
 	/// The amount of force the player exerts.
 	static constexpr Number inputForce = 0.25;
 
+	/// The amount a tuned coefficient changes by with each press.
+	static constexpr Number tuningStep = (Number::Epsilon * 4);
+
+	/// The largest that friction and restitution can be tuned to.
+	///
+	/// They must stay below one, because the world may store them as a fraction of a byte.
+	static constexpr Number tunedCoefficientMaximum = (1 - Number::Epsilon);
+
+	/// The largest that gravity and the input force can be tuned to.
+	static constexpr Number tunedForceMaximum = 2;
+
+	/// Objects moving slower than this on both axes are considered to be resting.
+	static constexpr Number sleepThreshold = 0.25;
+
+	/// The number of consecutive frames an object must rest for before it's put to sleep.
+	///
+	/// Sleeping objects are skipped by the simulation until something wakes them.
+	static constexpr uint8_t sleepDelay = 30;
+
+	/// The rate at which frames are drawn, in frames per second.
+	///
+	/// Velocities are measured in pixels per frame.
+	static constexpr uint8_t frameRate = 60;
+
+	/// The rate at which physics is simulated, in steps per second.
+	///
+	/// Setting this higher than the frame rate splits each frame into substeps,
+	/// which helps to keep fast objects from passing through each other.
+	static constexpr uint8_t physicsRate = 60;
+
+	/// The rate at which physics is simulated when the reduced rate is selected.
+	///
+	/// This halves the cost of physics on a busy screen,
+	/// at the expense of accuracy.
+	static constexpr uint8_t reducedPhysicsRate = (physicsRate / 2);
+
+	/// The most physics steps that may be simulated in a single frame.
+	static constexpr uint8_t maximumStepsPerFrame = 4;
+
+	/// The number of attractors and wind zones there's room for.
+	///
+	/// The game itself only uses gravity, which is a uniform field
+	/// and doesn't need any room, so these take no RAM unless they're raised.
+	static constexpr uint8_t attractorCapacity = 0;
+	static constexpr uint8_t windZoneCapacity = 0;
+
+	/// The number of contacts between objects that are remembered from one step to the next.
+	///
+	/// Under gravity, objects pile up, and the contacts holding them up
+	/// start each step from the impulse they needed on the last one,
+	/// so stacks settle with only a couple of iterations.
+	/// Contacts beyond this are still resolved, but aren't remembered.
+	static constexpr uint8_t contactCacheCapacity = 12;
+
+	/// The number of times the remembered contacts are solved each step.
+	static constexpr uint8_t contactIterations = 2;
+
+	/// The number of objects being simulated.
+	///
+	/// When a scene is loaded, this is the most objects it can have.
+	static constexpr uint8_t objectCount = PHYSIX_OBJECT_COUNT;
+
+	/// The scene to load at start up, from Scenes.h.
+	///
+	/// If this is `noScene`, the objects are placed randomly instead.
+	static constexpr Scene startScene = PHYSIX_SCENE;
+
+	/// The width and height of each object, in pixels.
+	static constexpr uint8_t objectSize = 8;
+
+	/// The collision layers that objects can be on.
+	///
+	/// Debris collides with the player and with solid objects, but not with other debris,
+	/// so pairs of debris are rejected before they're tested.
+	/// Triggers notice whatever is on the layers in their mask, without being pushed or pushing.
+	struct ObjectLayers
+	{
+		static constexpr uint8_t Player = (1 << 0);
+		static constexpr uint8_t Solid = (1 << 1);
+		static constexpr uint8_t Debris = (1 << 2);
+		static constexpr uint8_t Trigger = (1 << 3);
+	};
+
+	/// Objects moving at least this fast on either axis are swept,
+	/// so that they stop at the edges of the screen instead of overshooting them.
+	///
+	/// Half an object's width per frame is as far as an object can overshoot
+	/// before it visibly passes through whatever it hits.
+	static constexpr Number sweepThreshold = (objectSize / 2);
+
+	/// The most particles that can be alive at once.
+	///
+	/// Each particle takes six bytes.
+	static constexpr uint8_t particleCapacity = 48;
+
+	/// The number of sparks thrown off each object when the objects are shaken up.
+	static constexpr uint8_t particleBurstSize = 6;
+
+	/// The longest a spark lives for, in frames.
+	static constexpr uint8_t particleLifetime = 45;
+
+	/// The number of contact events kept from each frame's physics steps,
+	/// which must be a power of two.
+	///
+	/// Room is kept for the end of every remembered contact that has begun,
+	/// so this should be well over `contactCacheCapacity`, leaving room for the other events.
+	/// When a frame has more events than fit, stays are lost first, then hits,
+	/// and a beginning that doesn't fit is reported on a later step instead.
+	/// Begins and ends always come in pairs.
+	///
+	/// Each event takes ten bytes.
+	/// Setting this to zero stops the world from working out events at all.
+	static constexpr uint8_t contactEventCapacity = 32;
+
+	static_assert((contactEventCapacity == 0) || (contactEventCapacity > contactCacheCapacity), "There must be room for the end of every remembered contact");
+
+	/// Objects that hit something at least this hard throw off sparks.
+	static constexpr Number impactSparkThreshold = 2;
+
+	/// The number of sparks thrown off by each hard impact.
+	static constexpr uint8_t impactSparkCount = 2;
+
+	/// The area of the screen, which is also the smallest the world can be.
+	static constexpr Bounds screenBounds { 0, 0, Arduboy2::width(), Arduboy2::height() };
+
+	/// A world almost two screens wide and two screens tall.
+	///
+	/// This is about as large as the world can be:
+	/// positions are Numbers, which can't reach 128,
+	/// and objects can pass an edge by up to the sweep threshold before they're brought back,
+	/// so the edges are kept well inside that.
+	static constexpr Bounds wideBounds { -120, -64, 120, 64 };
+
+	/// The boundaries for the sides of the world, which the objects bounce off.
+	///
+	/// The world takes the size of each object into account.
+	/// If the world is larger than the screen, the view follows the player around it.
+	static constexpr Bounds worldBounds = PHYSIX_WORLD;
+
+	/// Indicates whether the world is larger than the screen.
+	static constexpr bool worldScrolls = ((worldBounds.getWidth() > screenBounds.getWidth()) || (worldBounds.getHeight() > screenBounds.getHeight()));
+
+	/// Indicates whether objects far from the screen should be simulated at a reduced rate.
+	///
+	/// Only the objects near the screen are simulated on every step,
+	/// and the rest are held where they are on all but one in every few steps,
+	/// so time passes more slowly far from the screen, until the player comes near.
+	/// This has no effect unless the world is larger than the screen.
+	static constexpr bool regionOfInterestEnabled = true;
+
+	/// How far beyond the edges of the screen objects are simulated on every step, in pixels.
+	///
+	/// Objects just off screen are simulated as well,
+	/// so that nothing on screen is pushed by something that's being held still.
+	static constexpr uint8_t regionMargin = 16;
+
+	/// Objects far from the screen are simulated on one in every this many steps.
+	static constexpr uint8_t distantStepInterval = 4;
+
 private:
 	/// An instance of the Arduboy2 API.
 	Arduboy2 arduboy;
 
 	/// The objects floating around the screen.
-	RigidBody objects[8];
+	///
+	/// The world stores each property of the objects in its own array,
+	/// so each stage of the simulation only touches the properties it needs.
+	///
+	/// It tells the queue about every contact as it happens,
+	/// and the game reacts to them once the frame's steps are over.
+	PhysicsWorld<objectCount, PHYSIX_PRECISION, SymplecticEuler, ContactEventQueue<contactEventCapacity>> world;
+
+	/// Draws objects straight into the frame buffer.
+	using ObjectBlitter = SpriteBlitter<objectSize, objectSize>;
 
-	/// A reference to the object that will represent the player.
+	/// The index of the object that will represent the player.
 	///
-	/// `playerObject` always points to `objects[0]`,
-	/// so the two can be considered interchangeable.
-	RigidBody & playerObject = objects[0];
+	/// The player is spawned first and is never despawned,
+	/// and despawning only moves the last object,
+	/// so the player keeps this index for the whole game.
+	static constexpr uint8_t playerIndex = 0;
 
 	/// Indicates whether gravity should be simulated or not.
 	bool gravityEnabled = false;
 
+	/// The coefficients in use, which a scene can change.
+	SceneCoefficients coefficients { coefficientOfFriction, coefficientOfGravity, coefficientOfRestitution };
+
+	/// The scene's static geometry, which is read from flash as it's needed.
+	SceneGeometry geometry;
+
 	/// A vector representing the force of gravity.
 	Vector2 gravitationalForce { 0, coefficientOfGravity };
 
+	/// The force fields acting on the objects.
+	///
+	/// Gravity is registered as a uniform field while it's enabled.
+	ForceFields<attractorCapacity, windZoneCapacity> forceFields;
+
+	/// The contacts between objects from the last step.
+	ContactCache<contactCacheCapacity, PHYSIX_PRECISION::Velocity> contactCache;
+
+	/// The amount of force the player exerts, which can be tuned.
+	Number tunedInputForce = inputForce;
+
+	/// The pages of diagnostics that can be displayed.
+	enum class StatPage : uint8_t
+	{
+		Coefficients,
+		Tuning,
+		Profile,
+	};
+
+	/// The rows of the tuning page, from top to bottom.
+	///
+	/// The first rows are the tunable coefficients.
+	static constexpr uint8_t frictionRow = 0;
+	static constexpr uint8_t gravityRow = 1;
+	static constexpr uint8_t restitutionRow = 2;
+	static constexpr uint8_t inputForceRow = 3;
+	static constexpr uint8_t saveSnapshotRow = 4;
+	static constexpr uint8_t loadSnapshotRow = 5;
+	static constexpr uint8_t tuningRowCount = 6;
+
+	/// The selected row of the tuning page.
+	uint8_t tuningRow = frictionRow;
+
+	/// Indicates whether the tuning has changed since it was last saved.
+	bool tuningDirty = false;
+
+	/// What happened the last time the snapshot was saved.
+	enum class SnapshotStatus : uint8_t
+	{
+		Unsaved,
+		Saved,
+
+		/// The objects didn't fit, so the old snapshot was kept.
+		TooLarge,
+	};
+
+	SnapshotStatus snapshotStatus = SnapshotStatus::Unsaved;
+
 	/// Indicates whether diagnostics should be rendered or not.
 	bool statRenderingEnabled = true;
 
+	/// Indicates which page of diagnostics should be rendered.
+	StatPage statPage = StatPage::Coefficients;
+
+	/// Times each stage of the frame.
+	Profiler<profilerEnabled> profiler;
+
+	/// Records or plays back the player's input.
+	Replay<replayMode> replay;
+
+	/// Places and shakes up the objects.
+	///
+	/// It always starts from the same seed, unless input is being recorded or played back,
+	/// so every run starts the same way.
+	Random randomGenerator;
+
+	/// Sparks thrown off the objects when they're shaken up.
+	ParticleSystem<particleCapacity> particles;
+
+	/// The area covered by the particles when they were last drawn.
+	ParticleBounds renderedParticles {};
+
+	/// Streams the state of the world over serial.
+	Telemetry<telemetryEnabled, objectCount> telemetry;
+
+	/// The parts of the screen that changed this frame.
+	DirtyRegion<> dirtyRegion;
+
+	/// Where each object was last drawn.
+	int8_t renderedX[objectCount] {};
+	int8_t renderedY[objectCount] {};
+
+	/// Where objects that aren't drawn are said to have been drawn,
+	/// which is entirely off screen.
+	static constexpr int8_t offScreen = INT8_MIN;
+
+	/// The top left of the view of the world, in pixels.
+	int16_t cameraX = 0;
+	int16_t cameraY = 0;
+
+	/// The number of steps since the distant objects were last simulated.
+	uint8_t distantSteps = 0;
+
+	/// Indicates whether the whole screen must be redrawn next frame.
+	bool fullRedrawPending = true;
+
+	/// Decides how many physics steps to simulate each frame.
+	FixedTimestep timestep { frameRate, physicsRate, maximumStepsPerFrame };
+
+	static_assert(FixedTimestep::isValidRate(frameRate, physicsRate), "The physics rate is too low for the frame rate");
+	static_assert(FixedTimestep::isValidRate(frameRate, reducedPhysicsRate), "The reduced physics rate is too low for the frame rate");
+
 public:
 	/// Performs necessary set up procedures.
 	void setup()
@@ -76,15 +419,66 @@ public:
 		// Initialise the Arduboy.
 		arduboy.begin();
 
-		// Randomise the objects.
-		randomiseObjects();
+		// Set the rate at which frames are drawn.
+		arduboy.setFrameRate(frameRate);
+
+		// If input is being played back...
+		if(replayMode == ReplayMode::Playback)
+		{
+			// Print the recording, so that it can be kept.
+			Serial.begin(9600);
+			printReplay(Serial);
+		}
+
+		// If telemetry is being streamed...
+		if(telemetry.isEnabled)
+			// Open the serial port to stream it over.
+			Serial.begin(9600);
 
-		// Calculate the point at the centre of the screen.
-		constexpr auto centreScreen = Point2(Number(arduboy.width() / 2), Number(arduboy.height() / 2));
+		// If input is being recorded or played back...
+		if(replayMode != ReplayMode::Off)
+			// Use the recording's seed, so the objects start in the same places.
+			randomGenerator.seed(replay.begin(arduboy.generateRandomSeed()));
 
-		// Move the player's object to the centre of the screen, with zero velocity.
-		playerObject.position = centreScreen;
-		playerObject.velocity = Vector2(0, 0);
+		// If there's a scene to load...
+		if(isScene(startScene))
+		{
+			// Load the scene's objects and coefficients.
+			// (Its first object is the player.)
+			coefficients = loadScene(startScene, world);
+			gravitationalForce = Vector2(0, coefficients.gravity);
+			updateGravity();
+
+			// Keep the scene's geometry where it is.
+			geometry = SceneGeometry(startScene);
+		}
+		// If there's no scene...
+		else
+		{
+			// Spawn the objects, giving each its shape.
+			spawnObjects();
+
+			// Randomise the objects.
+			randomiseObjects();
+
+			// Calculate the point at the centre of the world.
+			constexpr auto centreWorld = Point2(Number((worldBounds.left + worldBounds.right) / 2), Number((worldBounds.top + worldBounds.bottom) / 2));
+
+			// Move the player's object to the centre of the world, with zero velocity.
+			world.setPosition(playerIndex, centreWorld);
+			world.setVelocity(playerIndex, Vector2(0, 0));
+		}
+
+		// Point the view at the player.
+		updateCamera();
+
+		// If any tuning has been saved...
+		if(loadTuning(coefficients, tunedInputForce))
+		{
+			// Use it instead, keeping gravity pointing down.
+			gravitationalForce = Vector2(0, coefficients.gravity);
+			updateGravity();
+		}
 	}
 
 	/// Loops continually.
@@ -95,85 +489,528 @@ public:
 			// Exit the loop.
 			return;
 
+		// Start timing the frame.
+		profiler.beginFrame();
+
 		// Update the Arduboy's button state variables.
 		arduboy.pollButtons();
 
+		// Record the buttons, or replace them with the recorded buttons.
+		arduboy.currentButtonState = replay.update(arduboy.currentButtonState);
+
 		// React to player input.
 		updateInput();
 
+		profiler.endStage(ProfileStage::Input);
+
+		// If the last frame took longer than it should have,
+		// only allow a single physics step this frame,
+		// so that the simulation slows down instead of the display.
+		// (Not while replaying though, because the steps taken
+		// must only depend upon the input, not on how fast the build is.)
+		const uint8_t stepLimit = (!replay.isActive() && (arduboy.cpuLoad() > 100)) ? 1 : maximumStepsPerFrame;
+
+		// Work out how many physics steps are due this frame.
+		const uint8_t steps = timestep.advanceFrame(stepLimit);
+
 		// Simulate physics.
-		simulatePhysics();
+		for(uint8_t step = 0; step < steps; ++step)
+			simulatePhysics();
+
+		// React to what the objects hit.
+		handleContactEvents();
+
+		// Move the particles, which always move once per frame.
+		updateParticles();
+
+		// Follow the player with the view.
+		updateCamera();
+
+		profiler.endStage(ProfileStage::Physics);
+
+		// If the whole screen needs to be redrawn...
+		if(statRenderingEnabled || fullRedrawPending)
+		{
+			// Clear the screen.
+			arduboy.clear();
+
+			// Draw the scene's geometry (to the frame buffer).
+			renderGeometry();
 
-		// Clear the screen.
-		arduboy.clear();
+			// Draw all objects (to the frame buffer).
+			renderObjects();
 
-		// Draw all objects (to the frame buffer).
-		renderObjects();
+			// Draw all particles (to the frame buffer).
+			renderParticles();
 
-		// If the diagnostics should be displayed.
-		if(statRenderingEnabled)
-			// Draw diagnostics.
-			renderDisplay();
+			// If the diagnostics should be displayed.
+			if(statRenderingEnabled)
+				// Draw diagnostics.
+				renderDisplay();
 
-		// Update the screen.
-		arduboy.display();
+			// The diagnostics change every frame, and once they're turned off
+			// they have to be redrawn over once more to get rid of them.
+			fullRedrawPending = statRenderingEnabled;
+
+			profiler.endStage(ProfileStage::Render);
+
+			// Update the screen.
+			arduboy.display();
+		}
+		// If only the objects are being drawn...
+		else
+		{
+			// Redraw only the parts of the screen that have changed.
+			renderChangedObjects();
+
+			profiler.endStage(ProfileStage::Render);
+
+			// Update only the parts of the screen that have changed.
+			dirtyRegion.display(arduboy.getBuffer());
+		}
+
+		profiler.endStage(ProfileStage::Display);
+
+		// Finish timing the frame.
+		profiler.endFrame();
+
+		// Write any finished runs of recorded input to EEPROM.
+		replay.flush();
+
+		// Describe the frame, and send as much telemetry as the serial port can take.
+		telemetry.record(world, profiler, steps);
+		telemetry.send(Serial);
+	}
+
+	/// Spawns every object, making every other object a circle, and the rest boxes.
+	///
+	/// The circles are debris, which pass through each other.
+	void spawnObjects()
+	{
+		for(uint8_t count = 0; count < objectCount; ++count)
+		{
+			// Despawning moves other objects to new indices,
+			// so the index has to be found from the handle.
+			const uint8_t index = world.getIndex(world.spawn());
+
+			// The player is always a box.
+			const bool isCircle = ((index != playerIndex) && ((index % 2) == 0));
+
+			world.setShape(index, isCircle ? BodyShape::Circle : BodyShape::Box, objectSize);
+
+			// If the object is the player...
+			if(index == playerIndex)
+				// Put it on its own layer.
+				world.setLayers(index, ObjectLayers::Player, CollisionLayers::All);
+			// If the object is a circle...
+			else if(isCircle)
+				// Make it debris, which ignores other debris.
+				world.setLayers(index, ObjectLayers::Debris, (CollisionLayers::All & ~ObjectLayers::Debris));
+			// If the object is a box...
+			else
+				// Make it solid.
+				world.setLayers(index, ObjectLayers::Solid, CollisionLayers::All);
+		}
 	}
 
 	/// Randomises the positions and velocities of all objects.
 	void randomiseObjects()
 	{
-		// For each object in objects...
-		for(RigidBody & object : objects)
+		// The objects are about to move somewhere else entirely.
+		world.forgetContacts(contactCache);
+
+		// For each object in the world...
+		for(uint8_t index = 0; index < world.getCount(); ++index)
 		{
-			// Give the obejct a random on screen position.
-			object.position = Point2(Number(random(arduboy.width())), Number(random(arduboy.height())));
+			// Static objects can't be moved.
+			if(world.isStatic(index))
+				continue;
+
+			// Give the obejct a random position in the world.
+			world.setPosition(index, Point2(Number(randomGenerator.nextBetween(worldBounds.left, worldBounds.right)), Number(randomGenerator.nextBetween(worldBounds.top, worldBounds.bottom))));
 
 			// Calculate a random x value.
-			const auto xInteger = random(-8, 8);
-			const auto xFraction = random(1 << Number::FractionSize);
-			const auto xOffset = Number(xInteger, xFraction);
+			const auto xOffset = randomGenerator.nextFixed<Number>(-8, 8);
 
 			// Calculate a random y value.
-			const auto yInteger = random(-8, 8);
-			const auto yFraction = random(1 << Number::FractionSize);
-			const auto yOffset = Number(yInteger, yFraction);
+			const auto yOffset = randomGenerator.nextFixed<Number>(-8, 8);
 
 			// If gravity is enabled...
 			if(gravityEnabled)
 			{
 				// Adjust the object's vertical velocity.
-				object.velocity += Vector2(0, yOffset);
+				world.addVelocity(index, Vector2(0, yOffset));
 			}
 			// If gravity not enabled...
 			else
 			{
 				// Adjust the object's full velocity.
-				object.velocity += Vector2(xOffset, yOffset);
+				world.addVelocity(index, Vector2(xOffset, yOffset));
 			}
 		}
 	}
 
-	/// Renders all objects
+	/// Renders all objects that are on screen
 	void renderObjects()
 	{
-		// Note that this time the index is being used to identify the player object.
-		for(uint8_t index = 0; index < arrayLength(objects); ++index)
+		for(uint8_t index = 0; index < world.getCount(); ++index)
 		{
-			RigidBody & object = objects[index];
+			int8_t x;
+			int8_t y;
 
-			// If the object isn't the player...
-			if(index > 0)
-				// Draw it as a filled rectangle.
-				arduboy.fillRect(static_cast<int8_t>(object.getX()), static_cast<int8_t>(object.getY()), 8, 8);
-			// If the object is the player...
-			else
-				// Draw it as an empty rectangle.
-				arduboy.drawRect(static_cast<int8_t>(object.getX()), static_cast<int8_t>(object.getY()), 8, 8);
+			// Objects that are off screen aren't drawn at all.
+			if(getScreenPosition(index, x, y))
+				renderObject(index, x, y);
+
+			// Remember where the object was drawn.
+			renderedX[index] = x;
+			renderedY[index] = y;
+		}
+	}
+
+	/// Renders only the objects that have moved,
+	/// and any objects that were drawn where they were.
+	void renderChangedObjects()
+	{
+		// Forget the last frame's changes.
+		dirtyRegion.clear();
+
+		// Mark the area covered by each moved object, both where it was and where it is.
+		for(uint8_t index = 0; index < world.getCount(); ++index)
+		{
+			int8_t x;
+			int8_t y;
+
+			getScreenPosition(index, x, y);
+
+			// If the object hasn't moved, nothing has changed.
+			// (That includes objects that were off screen and still are.)
+			if((x == renderedX[index]) && (y == renderedY[index]))
+				continue;
+
+			dirtyRegion.include(renderedX[index], renderedY[index], objectSize, objectSize);
+			dirtyRegion.include(x, y, objectSize, objectSize);
+
+			// Remember where the object will be drawn.
+			renderedX[index] = x;
+			renderedY[index] = y;
+		}
+
+		// Mark the area covered by the particles, both where they were and where they are.
+		const ParticleBounds bounds = particles.getBounds();
+
+		dirtyRegion.include(renderedParticles.x, renderedParticles.y, renderedParticles.width, renderedParticles.height);
+		dirtyRegion.include(bounds.x, bounds.y, bounds.width, bounds.height);
+
+		// Remember where the particles will be drawn.
+		renderedParticles = bounds;
+
+		// If nothing has moved, there's nothing to do.
+		if(dirtyRegion.isEmpty())
+			return;
+
+		// Erase the marked area.
+		dirtyRegion.erase(arduboy.getBuffer());
+
+		// Redraw any geometry that was partly erased.
+		for(uint8_t index = 0; index < geometry.getCount(); ++index)
+		{
+			const StaticShape shape = geometry.getShape(index);
+
+			if(dirtyRegion.overlaps(shape.x - cameraX, shape.y - cameraY, shape.width, shape.height))
+				renderShape(shape);
+		}
+
+		// Redraw every object that overlaps the marked area,
+		// including objects that haven't moved but were partly erased.
+		// (Drawing an object again over itself changes nothing,
+		// and objects that are off screen overlap nothing.)
+		for(uint8_t index = 0; index < world.getCount(); ++index)
+			if(dirtyRegion.overlaps(renderedX[index], renderedY[index], objectSize, objectSize))
+				renderObject(index, renderedX[index], renderedY[index]);
+
+		// Redraw every particle, which are all inside the marked area.
+		particles.render(arduboy.getBuffer());
+	}
+
+	/// Gets where an object is drawn on screen.
+	///
+	/// Returns false, giving the off screen position,
+	/// if none of the object is on screen.
+	bool getScreenPosition(uint8_t index, int8_t & x, int8_t & y) const
+	{
+		const int16_t screenX = (static_cast<int16_t>(world.getX(index)) - cameraX);
+		const int16_t screenY = (static_cast<int16_t>(world.getY(index)) - cameraY);
+
+		// If the object is off screen...
+		if(!screenBounds.overlaps(screenX, screenY, objectSize, objectSize))
+		{
+			// Say that it's where nothing is drawn.
+			x = offScreen;
+			y = offScreen;
+			return false;
+		}
+
+		x = static_cast<int8_t>(screenX);
+		y = static_cast<int8_t>(screenY);
+		return true;
+	}
+
+	/// Gets the part of the world that's on screen.
+	Bounds getView() const
+	{
+		return screenBounds.offset(cameraX, cameraY);
+	}
+
+	/// Moves the view to follow the player, keeping it inside the world.
+	///
+	/// The display can't be scrolled, so whenever the view moves the whole screen is redrawn,
+	/// and the particles, which are kept where they are on screen, are moved with it.
+	void updateCamera()
+	{
+		constexpr int16_t halfSize = (objectSize / 2);
+
+		const int16_t x = clampView(static_cast<int16_t>(world.getX(playerIndex)) + halfSize - (screenBounds.getWidth() / 2), worldBounds.left, worldBounds.right - screenBounds.getWidth());
+		const int16_t y = clampView(static_cast<int16_t>(world.getY(playerIndex)) + halfSize - (screenBounds.getHeight() / 2), worldBounds.top, worldBounds.bottom - screenBounds.getHeight());
+
+		// If the view hasn't moved, nothing needs to change.
+		if((x == cameraX) && (y == cameraY))
+			return;
+
+		// Keep the particles where they are in the world.
+		particles.scroll(cameraX - x, cameraY - y);
+
+		cameraX = x;
+		cameraY = y;
+
+		// Keep the world's broad phase over the screen, where most of the simulated objects are.
+		world.setGridOrigin(cameraX, cameraY);
+
+		// Everything on screen has moved.
+		fullRedrawPending = true;
+	}
+
+	/// Keeps one coordinate of the view within the specified limits,
+	/// or at the lower limit if the world is smaller than the screen.
+	static int16_t clampView(int16_t value, int16_t minimum, int16_t maximum)
+	{
+		if(value > maximum)
+			value = maximum;
+
+		if(value < minimum)
+			value = minimum;
+
+		return value;
+	}
+
+	/// Renders all particles.
+	void renderParticles()
+	{
+		particles.render(arduboy.getBuffer());
+
+		// Remember where the particles were drawn.
+		renderedParticles = particles.getBounds();
+	}
+
+	/// Throws sparks off every object that isn't static.
+	void emitParticles()
+	{
+		for(uint8_t index = 0; index < world.getCount(); ++index)
+		{
+			// Static objects don't move when shaken.
+			if(world.isStatic(index))
+				continue;
+
+			int8_t screenX;
+			int8_t screenY;
+
+			// Sparks off screen would never be seen.
+			if(!getScreenPosition(index, screenX, screenY))
+				continue;
+
+			// Throw the sparks from the centre of the object.
+			const int16_t centreX = (screenX + (objectSize / 2));
+			const int16_t centreY = (screenY + (objectSize / 2));
+
+			// An object that's only partly on screen may have its centre off screen.
+			if(!screenBounds.overlaps(centreX, centreY, 1, 1))
+				continue;
+
+			const auto x = static_cast<uint8_t>(centreX);
+			const auto y = static_cast<uint8_t>(centreY);
+
+			for(uint8_t spark = 0; spark < particleBurstSize; ++spark)
+			{
+				// Throw each spark in a random direction, for a random time.
+				const auto velocity = ParticleVelocity(randomGenerator.nextFixed<ParticleNumber>(-2, 2), randomGenerator.nextFixed<ParticleNumber>(-2, 2));
+				const auto lifetime = static_cast<uint8_t>(randomGenerator.nextBetween(particleLifetime / 2, particleLifetime));
+
+				// If there's no room for more sparks, stop.
+				if(!particles.spawn(x, y, velocity, lifetime))
+					return;
+			}
+		}
+	}
+
+	/// Throws sparks off every object that hit something hard during this frame's physics steps.
+	void handleContactEvents()
+	{
+		world.getListener().drain([this](const ContactEvent & event)
+		{
+			// Only the start of a hard impact throws off sparks.
+			if(((event.phase != ContactPhase::Begin) && (event.phase != ContactPhase::Hit)) || (event.impulse < impactSparkThreshold))
+				return;
+
+			int8_t screenX;
+			int8_t screenY;
+
+			// Sparks off screen would never be seen.
+			if(!getScreenPosition(event.first, screenX, screenY))
+				return;
+
+			// Throw the sparks from the side of the object that hit.
+			constexpr int8_t halfSize = (objectSize / 2);
+
+			const int16_t sideX = (screenX + halfSize + static_cast<int8_t>(event.normal.x * halfSize));
+			const int16_t sideY = (screenY + halfSize + static_cast<int8_t>(event.normal.y * halfSize));
+
+			// An object that's only partly on screen may have hit something off screen.
+			if(!screenBounds.overlaps(sideX, sideY, 1, 1))
+				return;
+
+			const auto x = static_cast<uint8_t>(sideX);
+			const auto y = static_cast<uint8_t>(sideY);
+
+			for(uint8_t spark = 0; spark < impactSparkCount; ++spark)
+			{
+				// Throw each spark in a random direction, for a random time.
+				const auto velocity = ParticleVelocity(randomGenerator.nextFixed<ParticleNumber>(-1, 1), randomGenerator.nextFixed<ParticleNumber>(-1, 1));
+				const auto lifetime = static_cast<uint8_t>(randomGenerator.nextBetween(particleLifetime / 4, particleLifetime / 2));
+
+				// If there's no room for more sparks, stop.
+				if(!particles.spawn(x, y, velocity, lifetime))
+					return;
+			}
+		});
+	}
+
+	/// Moves the particles by one frame.
+	void updateParticles()
+	{
+		// The particles fall under gravity too.
+		const ParticleVelocity acceleration = gravityEnabled ? ParticleVelocity(numberCast<ParticleNumber>(gravitationalForce.x), numberCast<ParticleNumber>(gravitationalForce.y)) : ParticleVelocity(0, 0);
+
+		particles.update(acceleration);
+	}
+
+	/// Renders the scene's geometry.
+	void renderGeometry()
+	{
+		for(uint8_t index = 0; index < geometry.getCount(); ++index)
+			renderShape(geometry.getShape(index));
+	}
+
+	/// Renders a single piece of geometry as an outline,
+	/// so that it can be told apart from the objects.
+	void renderShape(const StaticShape & shape)
+	{
+		const int16_t x = (shape.x - cameraX);
+		const int16_t y = (shape.y - cameraY);
+
+		// Shapes that are off screen aren't drawn at all.
+		if(!screenBounds.overlaps(x, y, shape.width, shape.height))
+			return;
+
+		// If the shape is a circle...
+		if(shape.shape == BodyShape::Circle)
+		{
+			// Draw it within its bounding box.
+			const uint8_t radius = ((shape.width - 1) / 2);
+
+			arduboy.drawCircle(x + radius, y + radius, radius);
+		}
+		// If the shape is a box...
+		else
+		{
+			arduboy.drawRect(x, y, shape.width, shape.height);
 		}
 	}
 
+	/// Renders a single object at the specified position.
+	void renderObject(uint8_t index, int8_t x, int8_t y)
+	{
+		// Note that this time the index is being used to identify the player object.
+
+		// If the object is the player...
+		if(index == playerIndex)
+			// Draw it as an empty square.
+			ObjectBlitter::draw(arduboy.getBuffer(), x, y, hollowSprite);
+		// If the object is a circle...
+		else if(world.getShape(index) == BodyShape::Circle)
+			// Draw it as a circle.
+			ObjectBlitter::draw(arduboy.getBuffer(), x, y, circleSprite);
+		// If the object is a box...
+		else
+			// Draw it as a filled square.
+			ObjectBlitter::draw(arduboy.getBuffer(), x, y, filledSprite);
+	}
+
 	/// Draws diagnostic information.
 	void renderDisplay()
+	{
+		// If the profile page is selected...
+		if(profiler.isEnabled && (statPage == StatPage::Profile))
+			// Draw the profile instead.
+			renderProfile();
+		// If the tuning page is selected...
+		else if(statPage == StatPage::Tuning)
+			// Draw the tuning.
+			renderTuning();
+		// If the coefficients page is selected...
+		else
+			// Draw the coefficients.
+			renderCoefficients();
+	}
+
+	/// Draws the tuning page.
+	void renderTuning()
+	{
+		// Print a reminder of what A does.
+		arduboy.println(tuningDirty ? F("Tune  A: save") : F("Tune"));
+
+		// Print the tunable coefficients.
+		renderTuningRow(frictionRow, F("F: "));
+		arduboy.println(static_cast<float>(coefficients.friction));
+		renderTuningRow(gravityRow, F("G: "));
+		arduboy.println(static_cast<float>(coefficients.gravity));
+		renderTuningRow(restitutionRow, F("R: "));
+		arduboy.println(static_cast<float>(coefficients.restitution));
+		renderTuningRow(inputForceRow, F("I: "));
+		arduboy.println(static_cast<float>(tunedInputForce));
+
+		// Print the snapshot actions.
+		renderTuningRow(saveSnapshotRow, F("Save snapshot"));
+
+		if(snapshotStatus == SnapshotStatus::Saved)
+			arduboy.print(F(" ok"));
+		else if(snapshotStatus == SnapshotStatus::TooLarge)
+			arduboy.print(F(" failed"));
+
+		arduboy.println();
+		renderTuningRow(loadSnapshotRow, F("Load snapshot"));
+		arduboy.println();
+	}
+
+	/// Draws the start of a row of the tuning page,
+	/// marking it if it's selected.
+	void renderTuningRow(uint8_t row, const __FlashStringHelper * label)
+	{
+		arduboy.print((row == tuningRow) ? '>' : ' ');
+		arduboy.print(label);
+	}
+
+	/// Draws the state of the simulation.
+	void renderCoefficients()
 	{
 		// Print whether gravity is enabled, and its direction.
 		arduboy.println(F("Gravity"));
@@ -182,11 +1019,53 @@ public:
 
 		// Print the various coefficients.
 		arduboy.print(F("G: "));
-		arduboy.println(static_cast<float>(coefficientOfGravity));
+		arduboy.println(static_cast<float>(coefficients.gravity));
 		arduboy.print(F("F: "));
-		arduboy.println(static_cast<float>(coefficientOfFriction));
+		arduboy.println(static_cast<float>(coefficients.friction));
 		arduboy.print(F("R: "));
-		arduboy.println(static_cast<float>(coefficientOfRestitution));
+		arduboy.println(static_cast<float>(coefficients.restitution));
+
+		// Print the physics rate.
+		arduboy.print(F("P: "));
+		arduboy.println(timestep.getStepRate());
+	}
+
+	/// Draws the time taken by each stage of the frame.
+	void renderProfile()
+	{
+		// Print the column headings.
+		arduboy.println(F("us  MIN AVG MAX"));
+
+		// Print the statistics for each stage.
+		arduboy.print(F("IN  "));
+		renderStatistics(profiler.getStatistics(ProfileStage::Input));
+
+		arduboy.print(F("PHY "));
+		renderStatistics(profiler.getStatistics(ProfileStage::Physics));
+
+		arduboy.print(F("REN "));
+		renderStatistics(profiler.getStatistics(ProfileStage::Render));
+
+		arduboy.print(F("DSP "));
+		renderStatistics(profiler.getStatistics(ProfileStage::Display));
+
+		arduboy.print(F("ALL "));
+		renderStatistics(profiler.getFrameStatistics());
+
+		// Print the percentage of each frame spent working.
+		arduboy.print(F("CPU "));
+		arduboy.print(profiler.getCpuLoad(frameRate));
+		arduboy.println('%');
+	}
+
+	/// Draws a single line of timing statistics.
+	void renderStatistics(const ProfileStatistics & statistics)
+	{
+		arduboy.print(statistics.minimum);
+		arduboy.print(' ');
+		arduboy.print(statistics.average);
+		arduboy.print(' ');
+		arduboy.println(statistics.maximum);
 	}
 
 	/// Updates the simulation state in reaction to player input.
@@ -197,19 +1076,50 @@ public:
 		{
 			// A - Shake up the other objects by applying random force.
 			if(arduboy.justPressed(A_BUTTON))
+			{
+				emitParticles();
 				randomiseObjects();
+			}
 
 			// Down - Toggle gravity on or off.
 			if(arduboy.justPressed(DOWN_BUTTON))
+			{
 				gravityEnabled = !gravityEnabled;
+				updateGravity();
+
+				// The remembered contacts were held together by the old gravity.
+				world.forgetContacts(contactCache);
+
+				// Resting objects need to react to the change.
+				world.wakeAll();
+			}
 
 			// Up - Invert gravity.
 			if(arduboy.justPressed(UP_BUTTON))
+			{
 				gravitationalForce = -gravitationalForce;
+				updateGravity();
+
+				// The remembered contacts were held together by the old gravity.
+				world.forgetContacts(contactCache);
 
-			// Left - toggle statRenderingEnabled on/off
+				// Resting objects need to react to the change.
+				world.wakeAll();
+			}
+
+			// Left - Step through the diagnostic pages, then turn statRenderingEnabled off
 			if(arduboy.justPressed(LEFT_BUTTON))
-				statRenderingEnabled = !statRenderingEnabled;
+				selectNextStatPage();
+
+			// Right - Toggle between the full and reduced physics rates.
+			if(arduboy.justPressed(RIGHT_BUTTON))
+				timestep.setStepRate((timestep.getStepRate() == physicsRate) ? reducedPhysicsRate : physicsRate);
+		}
+		// When the B button isn't held, and the tuning page is showing...
+		else if(statRenderingEnabled && (statPage == StatPage::Tuning))
+		{
+			// Edit the tuning instead of moving the player.
+			updateTuning();
 		}
 		// When the B button isn't held...
 		else
@@ -219,154 +1129,319 @@ public:
 			Vector2 playerForce = Vector2(0, 0);
 
 			if(arduboy.pressed(LEFT_BUTTON))
-				playerForce.x += -inputForce;
+				playerForce.x += -tunedInputForce;
 
 			if(arduboy.pressed(RIGHT_BUTTON))
-				playerForce.x += inputForce;
+				playerForce.x += tunedInputForce;
 
 			if(arduboy.pressed(UP_BUTTON))
-				playerForce.y += -inputForce;
+				playerForce.y += -tunedInputForce;
 
 			if(arduboy.pressed(DOWN_BUTTON))
-				playerForce.y += inputForce;
+				playerForce.y += tunedInputForce;
 
 			// The player's input can be thought of as a force
 			// to be enacted on the object that the player is controlling.
-			playerObject.velocity += playerForce;
+			// (Only applying a force when there is one allows the object to sleep.)
+			if(playerForce != Vector2(0, 0))
+				world.addVelocity(playerIndex, playerForce);
 
 			// If A is pressed...
 			if(arduboy.justPressed(A_BUTTON))
 				// Perform an 'emergency stop' by zeroing the velocity.
-				playerObject.velocity = Vector2(0, 0);
+				world.setVelocity(playerIndex, Vector2(0, 0));
 		}
 	}
 
-	/// Simulates the physics.
-	void simulatePhysics()
+	/// Edits the tuning in reaction to player input.
+	void updateTuning()
 	{
-		// Precalculate the boundaries for the sides of the screen.
-		constexpr int16_t screenLeft = 0;
-		constexpr int16_t screenRight = (Arduboy2::width() - 8);
-		constexpr int16_t screenTop = 0;
-		constexpr int16_t screenBottom = (Arduboy2::height() - 8);
+		// Up - Select the row above.
+		if(arduboy.justPressed(UP_BUTTON) && (tuningRow > 0))
+			--tuningRow;
+
+		// Down - Select the row below.
+		if(arduboy.justPressed(DOWN_BUTTON) && (tuningRow < (tuningRowCount - 1)))
+			++tuningRow;
 
-		// For each object in objects...
-		for(RigidBody & object : objects)
+		// Left - Decrease the selected coefficient.
+		if(arduboy.justPressed(LEFT_BUTTON))
+			adjustTuning(-tuningStep);
+
+		// Right - Increase the selected coefficient.
+		if(arduboy.justPressed(RIGHT_BUTTON))
+			adjustTuning(tuningStep);
+
+		// A - Save the tuning, or save or load the snapshot.
+		if(arduboy.justPressed(A_BUTTON))
 		{
-			// Simulate gravity.
-			if(gravityEnabled)
-				object.velocity += gravitationalForce;
+			// If a snapshot row is selected...
+			if(tuningRow == saveSnapshotRow)
+				snapshotStatus = saveSnapshot(world) ? SnapshotStatus::Saved : SnapshotStatus::TooLarge;
+			else if(tuningRow == loadSnapshotRow)
+				loadSnapshotIntoWorld();
+			// If a coefficient is selected, and the tuning has changed...
+			else if(tuningDirty)
+			{
+				// Save the tuning.
+				// (Only the bytes that have changed are written.)
+				saveTuning(coefficients, tunedInputForce);
+				tuningDirty = false;
+			}
+		}
+	}
 
-			// Simulate friction.
+	/// Changes the selected coefficient by the specified amount,
+	/// keeping it within its limits.
+	void adjustTuning(Number change)
+	{
+		Number * value;
+		Number maximum;
 
-			// If gravity is enabled...
-			if(gravityEnabled)
-				// Simulate only horizontal friction.
-				object.velocity.x *= coefficientOfFriction;
-			// If gravity isn't enabled...
-			else
-				// Simulate full friction.
-				object.velocity *= coefficientOfFriction;
+		switch(tuningRow)
+		{
+			case frictionRow:
+				value = &coefficients.friction;
+				maximum = tunedCoefficientMaximum;
+				break;
+
+			case gravityRow:
+				value = &coefficients.gravity;
+				maximum = tunedForceMaximum;
+				break;
+
+			case restitutionRow:
+				value = &coefficients.restitution;
+				maximum = tunedCoefficientMaximum;
+				break;
+
+			case inputForceRow:
+				value = &tunedInputForce;
+				maximum = tunedForceMaximum;
+				break;
+
+			// The snapshot rows have nothing to adjust.
+			default:
+				return;
+		}
 
-			// Keep the objects on screen by bouncing them off the walls.
+		// Clamp the result to the limits.
+		const Number result = (*value + change);
+		*value = (result < 0) ? Number(0) : (result > maximum) ? maximum : result;
 
-			// If the object has gone off the left side of the screen...
-			if(object.position.x < screenLeft)
-			{
-				// Move the object to the left hand side of the screen.
-				object.position.x = screenLeft;
+		tuningDirty = true;
 
-				// Reverse the object's horizontal velocity.
-				object.velocity.x = -object.velocity.x;
-			}
+		// If gravity was changed...
+		if(tuningRow == gravityRow)
+		{
+			// Keep it pointing the same way.
+			gravitationalForce = Vector2(0, (gravitationalForce.y < 0) ? -coefficients.gravity : coefficients.gravity);
+			updateGravity();
+		}
 
-			// If the object has gone off the right side of the screen...
-			if(object.position.x > screenRight)
-			{
-				// Move the object to the right hand side of the screen.
-				object.position.x = screenRight;
+		// Resting objects need to react to the change.
+		world.wakeAll();
+	}
 
-				// Reverse the object's horizontal velocity.
-				object.velocity.x = -object.velocity.x;
-			}
+	/// Replaces the objects with the snapshot in EEPROM, if there is one.
+	void loadSnapshotIntoWorld()
+	{
+		// If there's no snapshot...
+		if(!loadSnapshot(world))
+			// Leave the objects alone.
+			return;
 
-			// If gravity is enabled...
-			if(gravityEnabled)
-			{
-				// If the object has gone off the top side of the screen...
-				if(object.position.y < screenTop)
-				{
-					// Move the object to the top side of the screen.
-					object.position.y = screenTop;
-
-					// If the object is moving faster (vertically) than the restitution threshold...
-					if(object.velocity.y > restitutionThreshold)
-					{
-						// Reverse the object's vertical velocity.
-						object.velocity.y = -object.velocity.y;
-
-						// Reduce the object's velocity by the coefficient of restitution.
-						object.velocity.y *= coefficientOfRestitution;
-					}
-					// If the object is moving slower (vertically) than the restitution threshold...
-					else
-					{
-						// Set the object's vertical velocity to zero.
-						// I.e. bring it to a vertical halt.
-						object.velocity.y = 0;
-					}
-				}
-
-				// If the object has gone off the bottom side of the screen...
-				if(object.position.y > screenBottom)
-				{
-					// Move the object to the bottom side of the screen.
-					object.position.y = screenBottom;
-
-					// If the object is moving faster (vertically) than the restitution threshold...
-					if(object.velocity.y > restitutionThreshold)
-					{
-						// Reverse the object's vertical velocity.
-						object.velocity.y = -object.velocity.y;
-
-						// Reduce the object's velocity by the coefficient of restitution.
-						object.velocity.y *= coefficientOfRestitution;
-					}
-					// If the object is moving slower (vertically) than the restitution threshold...
-					else
-					{
-						// Set the object's vertical velocity to zero.
-						// I.e. bring it to a vertical halt.
-						object.velocity.y = 0;
-					}
-				}
-			}
-			// If gravity isn't enabled...
+		// The objects may have moved anywhere.
+		fullRedrawPending = true;
+		world.forgetContacts(contactCache);
+	}
+
+	/// Selects the next page of diagnostics,
+	/// or turns diagnostics off after the last page.
+	void selectNextStatPage()
+	{
+		// If diagnostics are off...
+		if(!statRenderingEnabled)
+		{
+			// Turn them on at the first page.
+			statRenderingEnabled = true;
+			statPage = StatPage::Coefficients;
+		}
+		// If the first page is showing...
+		else if(statPage == StatPage::Coefficients)
+		{
+			// Show the tuning page.
+			statPage = StatPage::Tuning;
+		}
+		// If the tuning page is showing and there is a profile page...
+		else if(profiler.isEnabled && (statPage == StatPage::Tuning))
+		{
+			// Show the profile page.
+			statPage = StatPage::Profile;
+		}
+		// If the last page is showing...
+		else
+		{
+			// Turn diagnostics off.
+			statRenderingEnabled = false;
+		}
+	}
+
+	/// Registers gravity with the force fields if it's enabled,
+	/// replacing whatever gravity was registered before.
+	void updateGravity()
+	{
+		forceFields.clearUniformFields();
+
+		// If gravity is enabled...
+		if(gravityEnabled)
+			// Make it a uniform field.
+			forceFields.addUniformField(gravitationalForce);
+	}
+
+	/// Whether the objects are falling under gravity.
+	///
+	/// The physics step is compiled once for each mode,
+	/// so gravity is only checked once per step rather than at each stage.
+	enum class GravityMode : uint8_t
+	{
+		Off,
+		On,
+	};
+
+	/// Applies friction to every object.
+	///
+	/// The friction is either a Number or a ConstantFactor.
+	template< GravityMode gravityMode, typename Friction >
+	void applyFriction(Friction friction)
+	{
+		// Simulate horizontal friction.
+		world.applyHorizontalFriction(friction);
+
+		// If gravity isn't enabled...
+		// (This is decided at compile time.)
+		if(gravityMode == GravityMode::Off)
+			// Simulate vertical friction too.
+			world.applyVerticalFriction(friction);
+	}
+
+	/// Keeps the objects in the world by bouncing them off its edges.
+	template< GravityMode gravityMode >
+	void bounceOffEdges()
+	{
+		// If gravity is enabled...
+		// (This is decided at compile time.)
+		if(gravityMode == GravityMode::On)
+		{
+			// Reduce the objects' vertical velocity by the coefficient of restitution,
+			// bringing them to a vertical halt if they're moving slower than the restitution threshold.
+			if(coefficients.restitution == coefficientOfRestitution)
+				world.bounceOffEdges(worldBounds.left, worldBounds.top, worldBounds.right, worldBounds.bottom, RestitutionFactor(), restitutionThreshold);
 			else
-			{
-				// If the object has gone off the top side of the screen...
-				if(object.position.y < screenTop)
-				{
-					// Move the object to the top side of the screen.
-					object.position.y = screenTop;
-
-					// Reverse the object's vertical velocity.
-					object.velocity.y = -object.velocity.y;
-				}
-
-				// If the object has gone off the bottom side of the screen...
-				if(object.position.y > screenBottom)
-				{
-					// Move the object to the bottom side of the screen.
-					object.position.y = screenBottom;
-
-					// Reverse the object's vertical velocity.
-					object.velocity.y = -object.velocity.y;
-				}
-			}
+				world.bounceOffEdges(worldBounds.left, worldBounds.top, worldBounds.right, worldBounds.bottom, coefficients.restitution, restitutionThreshold);
+		}
+		// If gravity isn't enabled...
+		else
+		{
+			// Simply reverse the objects' velocity.
+			world.bounceOffEdges(worldBounds.left, worldBounds.top, worldBounds.right, worldBounds.bottom);
+		}
+	}
+
+	/// Simulates one physics step.
+	///
+	/// Each stage is a pass over every object in the world,
+	/// rather than every stage being applied to one object at a time.
+	void simulatePhysics()
+	{
+		// Get the length of the step, measured in frames.
+		const Number timeStep = timestep.getTimeStep();
+
+		// If objects far from the screen are simulated at a reduced rate...
+		// (This is decided at compile time.)
+		if(regionOfInterestEnabled && worldScrolls)
+			// Choose the objects to simulate.
+			selectSimulatedObjects();
+
+		// Choose the step for the gravity mode, once for the whole step.
+		if(gravityEnabled)
+			simulatePhysics<GravityMode::On>(timeStep);
+		else
+			simulatePhysics<GravityMode::Off>(timeStep);
+	}
 
-			// Finally, the object's update position using the object's velocity.
-			object.position += object.velocity;
+	/// Chooses the objects that the next physics step simulates:
+	/// every object on one in every few steps, and only the objects near the screen on the rest.
+	void selectSimulatedObjects()
+	{
+		++distantSteps;
+
+		// If it's time to simulate the distant objects...
+		if(distantSteps >= distantStepInterval)
+		{
+			// Simulate everything.
+			distantSteps = 0;
+			world.simulateEverywhere();
+		}
+		// If it isn't...
+		else
+		{
+			// Hold the distant objects where they are.
+			world.simulateInside(getView().inflate(regionMargin));
 		}
 	}
-};
+
+	/// Simulates one physics step in the specified gravity mode.
+	template< GravityMode gravityMode >
+	void simulatePhysics(Number timeStep)
+	{
+		// Simulate gravity and any other force fields.
+		world.applyForceFields(forceFields, timeStep);
+
+		// If each step is one frame long, and the friction hasn't been changed...
+		if((timeStep == 1) && (coefficients.friction == coefficientOfFriction))
+			// Simulate friction with the constant factor.
+			applyFriction<gravityMode>(FrictionFactor());
+		// If the step rate or the friction has been changed...
+		else
+			// Scale the effect of friction to the length of the step.
+			// (For friction close to 1 this is very close to raising it to the power of the time step.)
+			applyFriction<gravityMode>(1 - ((1 - coefficients.friction) * timeStep));
+
+		// Keep the objects in the world by bouncing them off the walls.
+		bounceOffEdges<gravityMode>();
+
+		// Under gravity, objects lose energy when they hit something, so that they can come to rest.
+		const Number restitution = ((gravityMode == GravityMode::On) ? coefficients.restitution : Number(1));
+
+		// Finally, update the objects' positions using their velocities,
+		// stopping fast objects at anything they would pass through.
+		world.integrate(timeStep, sweepThreshold, worldBounds.left, worldBounds.top, worldBounds.right, worldBounds.bottom, restitution, geometry);
+
+		// Make the objects bounce off each other, and then off the scene's geometry.
+		// Under gravity, the contacts between objects are remembered,
+		// so that piles of objects settle instead of jittering.
+		if(gravityMode == GravityMode::On)
+		{
+			// An object resting on another gains a step's worth of gravity before it's stopped,
+			// so only faster impacts bounce.
+			const Number impactThreshold = (restitutionThreshold + (coefficients.gravity * timeStep));
+
+			world.resolveCollisions<contactIterations>(contactCache, restitution, impactThreshold);
+		}
+		else
+		{
+			world.resolveCollisions(restitution);
+		}
+
+		world.resolveCollisions(geometry, restitution);
+
+		// Under gravity, an object resting on the floor still gains
+		// a frame's worth of gravity before the floor stops it,
+		// so the threshold has to allow for that.
+		const Number gravitySleepThreshold = (sleepThreshold + coefficients.gravity);
+
+		// Put objects that have come to rest to sleep.
+		world.updateSleep(((gravityMode == GravityMode::On) ? gravitySleepThreshold : sleepThreshold), sleepDelay);
+	}
+};
\ No newline at end of file
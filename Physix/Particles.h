@@ -0,0 +1,282 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduboy2.h>
+
+#include "Physics.h"
+
+/// The number type of a particle's velocity, which is a single byte.
+using ParticleNumber = SFixed<3, 4>;
+
+/// A particle's velocity in pixels per frame, or its acceleration in pixels per frame per frame,
+/// to the nearest sixteenth of a pixel.
+using ParticleVelocity = BasicVector2<ParticleNumber>;
+
+/// The area of the screen covered by a set of particles.
+///
+/// An empty area has no width.
+struct ParticleBounds
+{
+	uint8_t x;
+	uint8_t y;
+	uint8_t width;
+	uint8_t height;
+};
+
+/// A set of short lived single pixel particles, for effects like sparks and debris.
+///
+/// Particles are much smaller than bodies:
+/// each is six bytes, a byte each for the whole pixels of its position,
+/// one byte for the sixteenths of a pixel of both coordinates,
+/// a byte each for its velocity in sixteenths of a pixel per frame,
+/// and a byte for the number of frames it has left to live.
+/// They have no mass, collide with nothing, and only bounce off the edges of the screen,
+/// losing half their speed each time.
+///
+/// Each field is kept in its own array, like the world's bodies,
+/// so that each pass is a simple loop over bytes.
+/// Particles that die are replaced by the last particle,
+/// so the live particles are always the first `getCount()`.
+template< uint8_t capacityValue, uint8_t widthValue = WIDTH, uint8_t heightValue = HEIGHT >
+class ParticleSystem
+{
+public:
+	static constexpr uint8_t capacity = capacityValue;
+	static constexpr uint8_t width = widthValue;
+	static constexpr uint8_t height = heightValue;
+
+	/// The number of bits of each coordinate below the pixel.
+	static constexpr uint8_t fractionSize = 4;
+
+	static_assert(width <= 128, "Positions in sixteenths of a pixel must fit in an int16_t");
+	static_assert(height <= 128, "Positions in sixteenths of a pixel must fit in an int16_t");
+
+private:
+	static constexpr uint8_t fractionMask = ((1 << fractionSize) - 1);
+
+	// The edges of the screen, in sixteenths of a pixel.
+	static constexpr int16_t rightEdge = ((width - 1) << fractionSize);
+	static constexpr int16_t bottomEdge = ((height - 1) << fractionSize);
+
+private:
+	uint8_t x[capacity];
+	uint8_t y[capacity];
+
+	/// The fraction of x in the high nibble, and the fraction of y in the low nibble.
+	uint8_t fractions[capacity];
+
+	int8_t vx[capacity];
+	int8_t vy[capacity];
+	uint8_t lifetimes[capacity];
+
+	uint8_t count = 0;
+
+public:
+	uint8_t getCount() const
+	{
+		return count;
+	}
+
+	bool isFull() const
+	{
+		return (count >= capacity);
+	}
+
+	/// Removes every particle.
+	void clear()
+	{
+		count = 0;
+	}
+
+	/// Adds a particle at the specified pixel, which lives for the specified number of frames.
+	///
+	/// Returns false, and does nothing, if the system is full.
+	bool spawn(uint8_t pixelX, uint8_t pixelY, ParticleVelocity velocity, uint8_t lifetime)
+	{
+		if(isFull() || (lifetime == 0))
+			return false;
+
+		x[count] = (pixelX < width) ? pixelX : (width - 1);
+		y[count] = (pixelY < height) ? pixelY : (height - 1);
+
+		// Start in the middle of the pixel.
+		fractions[count] = 0x88;
+
+		vx[count] = velocity.x.getInternal();
+		vy[count] = velocity.y.getInternal();
+		lifetimes[count] = lifetime;
+
+		++count;
+
+		return true;
+	}
+
+	/// Advances every particle by one frame,
+	/// accelerating it by the specified acceleration, in pixels per frame per frame.
+	void update(ParticleVelocity acceleration)
+	{
+		// Age the particles first, so the dead are never moved.
+		for(uint8_t index = 0; index < count;)
+		{
+			--lifetimes[index];
+
+			// If the particle is still alive...
+			if(lifetimes[index] != 0)
+			{
+				++index;
+				continue;
+			}
+
+			// Replace it with the last particle.
+			remove(index);
+		}
+
+		if(acceleration.x != 0)
+			accelerate(vx, acceleration.x.getInternal());
+
+		if(acceleration.y != 0)
+			accelerate(vy, acceleration.y.getInternal());
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			const uint8_t fraction = fractions[index];
+
+			const int16_t newX = move(x[index], (fraction >> fractionSize), vx[index], rightEdge);
+			const int16_t newY = move(y[index], (fraction & fractionMask), vy[index], bottomEdge);
+
+			x[index] = static_cast<uint8_t>(newX >> fractionSize);
+			y[index] = static_cast<uint8_t>(newY >> fractionSize);
+			fractions[index] = static_cast<uint8_t>(((newX & fractionMask) << fractionSize) | (newY & fractionMask));
+		}
+	}
+
+	/// Moves every particle by the specified number of whole pixels,
+	/// such as when the view of the world scrolls,
+	/// removing the particles that leave the screen.
+	void scroll(int16_t offsetX, int16_t offsetY)
+	{
+		for(uint8_t index = 0; index < count;)
+		{
+			const int16_t newX = (x[index] + offsetX);
+			const int16_t newY = (y[index] + offsetY);
+
+			// If the particle has left the screen...
+			if((newX < 0) || (newX >= width) || (newY < 0) || (newY >= height))
+			{
+				// Replace it with the last particle.
+				remove(index);
+				continue;
+			}
+
+			x[index] = static_cast<uint8_t>(newX);
+			y[index] = static_cast<uint8_t>(newY);
+
+			++index;
+		}
+	}
+
+	/// Gets the area covered by the particles.
+	ParticleBounds getBounds() const
+	{
+		if(count == 0)
+			return ParticleBounds { 0, 0, 0, 0 };
+
+		uint8_t left = width;
+		uint8_t top = height;
+		uint8_t right = 0;
+		uint8_t bottom = 0;
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			if(x[index] < left)
+				left = x[index];
+
+			if(x[index] > right)
+				right = x[index];
+
+			if(y[index] < top)
+				top = y[index];
+
+			if(y[index] > bottom)
+				bottom = y[index];
+		}
+
+		return ParticleBounds { left, top, static_cast<uint8_t>(right - left + 1), static_cast<uint8_t>(bottom - top + 1) };
+	}
+
+	/// Draws each particle as a single white pixel,
+	/// directly into the specified frame buffer.
+	void render(uint8_t * buffer) const
+	{
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			const uint8_t row = y[index];
+
+			// Each byte of the frame buffer is a column of eight pixels.
+			buffer[((row / 8) * width) + x[index]] |= static_cast<uint8_t>(1 << (row % 8));
+		}
+	}
+
+private:
+	// Replaces the specified particle with the last particle.
+	void remove(uint8_t index)
+	{
+		--count;
+		x[index] = x[count];
+		y[index] = y[count];
+		fractions[index] = fractions[count];
+		vx[index] = vx[count];
+		vy[index] = vy[count];
+		lifetimes[index] = lifetimes[count];
+	}
+
+	// Adds the acceleration to each velocity, saturating rather than wrapping.
+	void accelerate(int8_t * velocities, int8_t acceleration)
+	{
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			const int16_t velocity = (velocities[index] + acceleration);
+
+			velocities[index] = static_cast<int8_t>((velocity > INT8_MAX) ? INT8_MAX : (velocity < INT8_MIN) ? INT8_MIN : velocity);
+		}
+	}
+
+	// Moves a coordinate by its velocity, bouncing it off either edge.
+	// Returns the new coordinate in sixteenths of a pixel.
+	static int16_t move(uint8_t pixel, uint8_t fraction, int8_t & velocity, int16_t edge)
+	{
+		const int16_t position = (((static_cast<int16_t>(pixel) << fractionSize) | fraction) + velocity);
+
+		// If the particle has passed an edge,
+		// stop it there and send it back at half the speed.
+		if(position < 0)
+		{
+			velocity = static_cast<int8_t>(-(velocity / 2));
+			return 0;
+		}
+
+		if(position > edge)
+		{
+			velocity = static_cast<int8_t>(-(velocity / 2));
+			return edge;
+		}
+
+		return position;
+	}
+};
\ No newline at end of file
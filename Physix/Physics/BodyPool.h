@@ -0,0 +1,139 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Hands out handles to a fixed number of bodies,
+// keeping the live bodies packed together at the start of the world's arrays.
+//
+// A body's slot is its position in the world's arrays,
+// and its handle is an identifier that stays the same for as long as it's alive.
+// Releasing a body moves the last live body into its slot,
+// so passes only ever have to loop over the live bodies,
+// and the handle table records where each body has moved to.
+//
+// Free handles form a linked list threaded through the handle table,
+// so allocating and releasing take constant time and no extra memory.
+template< uint8_t capacityValue >
+class BodyPool
+{
+public:
+	// Constants
+	static constexpr uint8_t capacity = capacityValue;
+
+	// Returned when there are no handles left
+	static constexpr uint8_t invalidHandle = UINT8_MAX;
+
+	static_assert(capacity < invalidHandle, "The capacity must leave room for the invalid handle");
+
+private:
+	// Fields
+
+	// The slot of each live handle, or the next free handle for each free one
+	uint8_t slots[capacity];
+
+	// The handle of the body in each live slot
+	uint8_t handles[capacity];
+
+	uint8_t count;
+	uint8_t firstFree;
+
+public:
+	// Constructors
+	BodyPool()
+	{
+		this->clear();
+	}
+
+	// Releases every body
+	void clear()
+	{
+		for(uint8_t handle = 0; handle < capacity; ++handle)
+			this->slots[handle] = (handle + 1);
+
+		this->slots[capacity - 1] = invalidHandle;
+		this->count = 0;
+		this->firstFree = 0;
+	}
+
+	// The number of live bodies, which occupy the slots from zero up to but not including it
+	uint8_t getCount() const
+	{
+		return this->count;
+	}
+
+	bool isEmpty() const
+	{
+		return (this->count == 0);
+	}
+
+	bool isFull() const
+	{
+		return (this->count == capacity);
+	}
+
+	// Note: only valid for live handles
+	uint8_t getSlot(uint8_t handle) const
+	{
+		return this->slots[handle];
+	}
+
+	// Note: only valid for live slots
+	uint8_t getHandle(uint8_t slot) const
+	{
+		return this->handles[slot];
+	}
+
+	// Returns the handle of a new body in the slot after the last live body,
+	// or invalidHandle if the pool is full
+	uint8_t allocate()
+	{
+		const uint8_t handle = this->firstFree;
+
+		if(handle == invalidHandle)
+			return invalidHandle;
+
+		this->firstFree = this->slots[handle];
+
+		this->slots[handle] = this->count;
+		this->handles[this->count] = handle;
+		++this->count;
+
+		return handle;
+	}
+
+	// Releases a live handle, moving the last live body into its slot.
+	// Returns the slot the body occupied,
+	// which the caller must fill with the body from the slot at getCount().
+	uint8_t release(uint8_t handle)
+	{
+		const uint8_t slot = this->slots[handle];
+
+		--this->count;
+
+		const uint8_t movedHandle = this->handles[this->count];
+
+		this->handles[slot] = movedHandle;
+		this->slots[movedHandle] = slot;
+
+		this->slots[handle] = this->firstFree;
+		this->firstFree = handle;
+
+		return slot;
+	}
+};
\ No newline at end of file
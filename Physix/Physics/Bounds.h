@@ -0,0 +1,78 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// An area of the world, such as the world itself, or the part of it on screen.
+//
+// Unlike a Rectangle, its edges are integers,
+// so it can reach the ends of a Number's range, and be wider than 255 pixels.
+// The right and bottom edges are exclusive.
+class Bounds
+{
+public:
+	// Fields
+	int16_t left = 0;
+	int16_t top = 0;
+	int16_t right = 0;
+	int16_t bottom = 0;
+
+public:
+	// Constructors
+	constexpr Bounds() = default;
+
+	constexpr Bounds(int16_t left, int16_t top, int16_t right, int16_t bottom) :
+		left { left },
+		top { top },
+		right { right },
+		bottom { bottom }
+	{
+	}
+
+	constexpr int16_t getWidth() const
+	{
+		return (this->right - this->left);
+	}
+
+	constexpr int16_t getHeight() const
+	{
+		return (this->bottom - this->top);
+	}
+
+	// Returns the bounds moved by the specified number of pixels
+	constexpr Bounds offset(int16_t x, int16_t y) const
+	{
+		return Bounds(this->left + x, this->top + y, this->right + x, this->bottom + y);
+	}
+
+	// Returns the bounds grown by the specified number of pixels on every side
+	constexpr Bounds inflate(uint8_t margin) const
+	{
+		return Bounds(this->left - margin, this->top - margin, this->right + margin, this->bottom + margin);
+	}
+
+	// Returns true if any of the specified pixels are inside the bounds
+	constexpr bool overlaps(int16_t x, int16_t y, uint8_t width, uint8_t height) const
+	{
+		return
+			(x < this->right) &&
+			((x + width) > this->left) &&
+			(y < this->bottom) &&
+			((y + height) > this->top);
+	}
+};
\ No newline at end of file
@@ -20,91 +20,101 @@
 #include "Point.h"
 #include "Size.h"
 
-class Circle
+template< typename T >
+class BasicCircle
 {
+public:
+	// Types
+	using Scalar = T;
+	using Point = BasicPoint2<T>;
+	using Size = BasicSize2<UnsignedType<T>>;
+
 public:
 	// Fields
-	Point2 position;
-	NumberU radius;
+	Point position;
+	UnsignedType<T> radius;
 
 public:
 	// Constructors
-	constexpr Circle() = default;
+	constexpr BasicCircle() = default;
 
-	constexpr Circle(Point2 position) :
+	constexpr BasicCircle(Point position) :
 		position { position },
 		radius { 1 }
 	{
 	}
 
-	constexpr Circle(Point2 position, NumberU radius) :
+	constexpr BasicCircle(Point position, UnsignedType<T> radius) :
 		position { position },
 		radius { radius }
 	{
 	}
 
-	constexpr Circle(Number x, Number y) :
+	constexpr BasicCircle(T x, T y) :
 		position { x, y },
 		radius { 1 }
 	{
 	}
 
-	constexpr Circle(Number x, Number y, NumberU radius) :
+	constexpr BasicCircle(T x, T y, UnsignedType<T> radius) :
 		position { x, y },
 		radius { radius }
 	{
 	}
 
-	constexpr Number getX() const
+	constexpr T getX() const
 	{
 		return this->position.x;
 	}
 
-	constexpr Number getY() const
+	constexpr T getY() const
 	{
 		return this->position.y;
 	}
 
-	constexpr Size2 getSize() const
+	constexpr Size getSize() const
 	{
-		return Size2(this->radius, this->radius);
+		return Size(this->radius, this->radius);
 	}
 
-	constexpr NumberU getWidth() const
+	constexpr UnsignedType<T> getWidth() const
 	{
 		return this->radius;
 	}
 
-	constexpr NumberU getHeight() const
+	constexpr UnsignedType<T> getHeight() const
 	{
 		return this->radius;
 	}
 
-	constexpr NumberU getDiameter() const
+	constexpr UnsignedType<T> getDiameter() const
 	{
 		return (this->radius * 2);
 	}
 
-	constexpr NumberU getRadiusSquared() const
+	constexpr UnsignedType<T> getRadiusSquared() const
 	{
 		return (this->radius * this->radius);
 	}
 
 	// Returns true if the point intersects the circle
-	constexpr bool intersects(Point2 point) const
+	constexpr bool intersects(Point point) const
 	{
 		return (distanceSquared(this->position, point) <= this->getRadiusSquared());
 	}
 
 	// Returns true if the point lies within the circle
-	constexpr bool contains(Point2 point) const
+	constexpr bool contains(Point point) const
 	{
 		return (distanceSquared(this->position, point) < this->getRadiusSquared());
 	}
 };
 
+using Circle = BasicCircle<Number>;
+
 // Returns true if the circles intersect each other
-constexpr inline bool intersects(Circle first, Circle second)
+template< typename T >
+constexpr inline bool intersects(BasicCircle<T> first, BasicCircle<T> second)
 {
 	return (distanceSquared(first.position, second.position) <= square(first.radius + second.radius));
 }
\ No newline at end of file
@@ -0,0 +1,284 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Circle.h"
+#include "Rectangle.h"
+#include "RigidBody.h"
+
+// Describes how two shapes overlap
+class Manifold
+{
+public:
+	// Fields
+
+	// The direction the second shape must move in to separate from the first, of length 1
+	Vector2 normal;
+
+	// How far the shapes overlap along the normal
+	Number penetration;
+
+public:
+	// Constructors
+	constexpr Manifold() = default;
+
+	constexpr Manifold(Vector2 normal, Number penetration) :
+		normal { normal },
+		penetration { penetration }
+	{
+	}
+};
+
+//
+// Collision detection
+//
+// Each test rejects shapes that are separated on either axis first,
+// because that's the cheapest test and the most common outcome.
+// Circles are positioned by their centres, rectangles by their top left corners.
+//
+
+// Returns true if the rectangles overlap, describing the overlap in the manifold.
+// The normal is along whichever axis they overlap least on.
+inline bool collide(Rectangle first, Rectangle second, Manifold & manifold)
+{
+	// Working from the centres avoids calculating the right and bottom edges,
+	// which can overflow at the edge of the screen
+	const Number halfWidths = fromUnsigned((first.getWidth() + second.getWidth()) * NumberU(0.5));
+	const Number offsetX = ((second.getX() - first.getX()) + ((fromUnsigned(second.getWidth()) - fromUnsigned(first.getWidth())) * Number(0.5)));
+	const Number overlapX = (halfWidths - absolute(offsetX));
+
+	if(overlapX <= 0)
+		return false;
+
+	const Number halfHeights = fromUnsigned((first.getHeight() + second.getHeight()) * NumberU(0.5));
+	const Number offsetY = ((second.getY() - first.getY()) + ((fromUnsigned(second.getHeight()) - fromUnsigned(first.getHeight())) * Number(0.5)));
+	const Number overlapY = (halfHeights - absolute(offsetY));
+
+	if(overlapY <= 0)
+		return false;
+
+	if(overlapX < overlapY)
+		manifold = Manifold(Vector2((offsetX < 0) ? -1 : 1, 0), overlapX);
+	else
+		manifold = Manifold(Vector2(0, (offsetY < 0) ? -1 : 1), overlapY);
+
+	return true;
+}
+
+// Returns true if the circles overlap, describing the overlap in the manifold
+inline bool collide(Circle first, Circle second, Manifold & manifold)
+{
+	const Number radii = fromUnsigned(first.radius + second.radius);
+	const Vector2 offset = (second.position - first.position);
+
+	if((absolute(offset.x) >= radii) || (absolute(offset.y) >= radii))
+		return false;
+
+	const NumberU distance = offset.getMagnitude();
+
+	if(fromUnsigned(distance) >= radii)
+		return false;
+
+	// Circles with the same centre are pushed apart horizontally
+	const Vector2 normal = (distance > 0) ? offset.getNormalised(distance) : Vector2(1, 0);
+
+	manifold = Manifold(normal, (radii - fromUnsigned(distance)));
+	return true;
+}
+
+// Returns true if the circle and rectangle overlap, describing the overlap in the manifold
+inline bool collide(Circle first, Rectangle second, Manifold & manifold)
+{
+	const Number radius = fromUnsigned(first.radius);
+	const Point2 centre = first.position;
+
+	// Offsets from the circle's centre to each edge of the rectangle
+	const Number left = (second.getX() - centre.x);
+	const Number top = (second.getY() - centre.y);
+	const Number right = (left + fromUnsigned(second.getWidth()));
+	const Number bottom = (top + fromUnsigned(second.getHeight()));
+
+	if((left >= radius) || (right <= -radius) || (top >= radius) || (bottom <= -radius))
+		return false;
+
+	// If the centre is inside the rectangle,
+	// push the rectangle out through whichever edge is nearest
+	if((left <= 0) && (right >= 0) && (top <= 0) && (bottom >= 0))
+	{
+		const Number distanceX = ((-left < right) ? -left : right);
+		const Number distanceY = ((-top < bottom) ? -top : bottom);
+
+		if(distanceX < distanceY)
+			manifold = Manifold(Vector2((-left < right) ? 1 : -1, 0), (distanceX + radius));
+		else
+			manifold = Manifold(Vector2(0, (-top < bottom) ? 1 : -1), (distanceY + radius));
+
+		return true;
+	}
+
+	// Otherwise the nearest point of the rectangle decides the normal
+	const Vector2 offset
+	(
+		(left > 0) ? left : (right < 0) ? right : Number(0),
+		(top > 0) ? top : (bottom < 0) ? bottom : Number(0)
+	);
+
+	const NumberU distance = offset.getMagnitude();
+
+	if(fromUnsigned(distance) >= radius)
+		return false;
+
+	manifold = Manifold(offset.getNormalised(distance), (radius - fromUnsigned(distance)));
+	return true;
+}
+
+// Returns true if the rectangle and circle overlap, describing the overlap in the manifold
+inline bool collide(Rectangle first, Circle second, Manifold & manifold)
+{
+	if(!collide(second, first, manifold))
+		return false;
+
+	manifold.normal = -manifold.normal;
+	return true;
+}
+
+//
+// Continuous collision detection
+//
+// A sweep moves a shape along a displacement and finds the first time it touches another,
+// as a fraction of the displacement, so fast shapes can't pass through each other between steps.
+//
+
+// Finds when a span moving along an axis enters and leaves a stationary span,
+// as fractions of the displacement.
+// Returns false if the spans don't overlap at any point during the displacement.
+// An entry time of -1 means the spans already overlap on this axis,
+// and an exit time of 2 means they still overlap at the end.
+inline bool sweepAxis(Number start, Number length, Number displacement, Number targetStart, Number targetLength, Number & entry, Number & exit)
+{
+	// Working from the centres avoids calculating the far edges,
+	// which can overflow at the edge of the screen
+	const Number halfLengths = ((length + targetLength) * Number(0.5));
+	const Number offset = ((targetStart - start) + ((targetLength - length) * Number(0.5)));
+
+	if(displacement == 0)
+	{
+		entry = -1;
+		exit = 2;
+		return (absolute(offset) < halfLengths);
+	}
+
+	// Distances measured in the direction of movement
+	const Number speed = absolute(displacement);
+	const Number distance = (displacement > 0) ? offset : -offset;
+	const Number entryDistance = (distance - halfLengths);
+	const Number exitDistance = (distance + halfLengths);
+
+	// If the target is too far ahead, or already behind...
+	if((entryDistance >= speed) || (exitDistance <= 0))
+		return false;
+
+	// Both times are worked out only when they're less than one,
+	// which keeps the divisions from overflowing
+	entry = (entryDistance < 0) ? Number(-1) : (entryDistance / speed);
+	exit = (exitDistance >= speed) ? Number(2) : (exitDistance / speed);
+	return true;
+}
+
+// Returns true if the moving rectangle touches the target before the end of the displacement,
+// giving the fraction of the displacement it can move before touching
+// and the normal of the side it touches, which points back towards the moving rectangle.
+// Rectangles that already overlap are left to the ordinary collision tests.
+inline bool sweep(Rectangle moving, Vector2 displacement, Rectangle target, Number & time, Vector2 & normal)
+{
+	Number entryX;
+	Number exitX;
+
+	if(!sweepAxis(moving.getX(), fromUnsigned(moving.getWidth()), displacement.x, target.getX(), fromUnsigned(target.getWidth()), entryX, exitX))
+		return false;
+
+	Number entryY;
+	Number exitY;
+
+	if(!sweepAxis(moving.getY(), fromUnsigned(moving.getHeight()), displacement.y, target.getY(), fromUnsigned(target.getHeight()), entryY, exitY))
+		return false;
+
+	// The rectangles touch once they overlap on both axes,
+	// and stop touching once they stop overlapping on either
+	const Number entry = (entryX > entryY) ? entryX : entryY;
+	const Number exit = (exitX < exitY) ? exitX : exitY;
+
+	if((entry < 0) || (entry >= exit))
+		return false;
+
+	time = entry;
+
+	if(entryX > entryY)
+		normal = Vector2((displacement.x > 0) ? -1 : 1, 0);
+	else
+		normal = Vector2(0, (displacement.y > 0) ? -1 : 1);
+
+	return true;
+}
+
+//
+// Collision response
+//
+
+// Calculates the impulse that stops two bodies approaching each other along the normal,
+// scaled up by the restitution so that they bounce apart.
+// Returns zero if the bodies are already separating.
+inline Number getImpulse(const Manifold & manifold, Vector2 relativeVelocity, Number totalInverseMass, Number restitution)
+{
+	const Number approachSpeed = dotProduct(relativeVelocity, manifold.normal);
+
+	if((approachSpeed >= 0) || (totalInverseMass == 0))
+		return 0;
+
+	return ((-approachSpeed * (1 + restitution)) / totalInverseMass);
+}
+
+// Pushes two overlapping bodies apart and exchanges momentum between them.
+// Lighter bodies move further and change speed more, and static bodies don't move at all.
+inline void resolveCollision(RigidBody & first, RigidBody & second, const Manifold & manifold, Number restitution)
+{
+	const Number firstInverseMass = first.getInverseMass();
+	const Number secondInverseMass = second.getInverseMass();
+	const Number totalInverseMass = (firstInverseMass + secondInverseMass);
+
+	if(totalInverseMass == 0)
+		return;
+
+	// Separate the bodies in proportion to their inverse masses
+	const Vector2 correction = (manifold.normal * (manifold.penetration / totalInverseMass));
+
+	first.position -= (correction * firstInverseMass);
+	second.position += (correction * secondInverseMass);
+
+	const Number impulse = getImpulse(manifold, (second.velocity - first.velocity), totalInverseMass, restitution);
+
+	if(impulse == 0)
+		return;
+
+	const Vector2 change = (manifold.normal * impulse);
+
+	first.velocity -= (change * firstInverseMass);
+	second.velocity += (change * secondInverseMass);
+}
\ No newline at end of file
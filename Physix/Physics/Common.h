@@ -22,14 +22,65 @@
 using Number = SFixed<7, 8>;
 using NumberU = UFixed<8, 8>;
 
-constexpr inline NumberU fromSigned(Number value)
+// Selects the unsigned fixed point type with the same bits as a signed one
+template< typename T >
+struct MakeUnsigned;
+
+template< unsigned Integer, unsigned Fraction >
+struct MakeUnsigned<SFixed<Integer, Fraction>>
+{
+	using Type = UFixed<Integer + 1, Fraction>;
+};
+
+template< typename T >
+using UnsignedType = typename MakeUnsigned<T>::Type;
+
+template< unsigned Integer, unsigned Fraction >
+constexpr inline UFixed<Integer + 1, Fraction> fromSigned(SFixed<Integer, Fraction> value)
 {
-	return NumberU::fromInternal(value.getInternal());
+	return UFixed<Integer + 1, Fraction>::fromInternal(value.getInternal());
 }
 
-constexpr inline Number fromUnsigned(NumberU value)
+template< unsigned Integer, unsigned Fraction >
+constexpr inline SFixed<Integer - 1, Fraction> fromUnsigned(UFixed<Integer, Fraction> value)
 {
-	return Number::fromInternal(value.getInternal());
+	return SFixed<Integer - 1, Fraction>::fromInternal(value.getInternal());
+}
+
+// Converts between fixed point formats of up to 16 bits by shifting the internal value
+// Converting to a format with fewer fractional bits rounds down
+template< typename To, typename From, bool gainsFraction = (To::FractionSize >= From::FractionSize) >
+struct NumberCast
+{
+	static constexpr To cast(From value)
+	{
+		return To::fromInternal(static_cast<typename To::InternalType>(static_cast<int32_t>(value.getInternal()) * (static_cast<int32_t>(1) << (To::FractionSize - From::FractionSize))));
+	}
+};
+
+template< typename To, typename From >
+struct NumberCast<To, From, false>
+{
+	static constexpr To cast(From value)
+	{
+		return To::fromInternal(static_cast<typename To::InternalType>(static_cast<int32_t>(value.getInternal()) >> (From::FractionSize - To::FractionSize)));
+	}
+};
+
+// Converting to the same format does nothing
+template< typename T >
+struct NumberCast<T, T, true>
+{
+	static constexpr T cast(T value)
+	{
+		return value;
+	}
+};
+
+template< typename To, typename From >
+constexpr inline To numberCast(From value)
+{
+	return NumberCast<To, From>::cast(value);
 }
 
 template< typename T >
@@ -38,6 +89,48 @@ constexpr auto square(T value) -> decltype(value * value)
 	return (value * value);
 }
 
+template< typename T >
+constexpr T absolute(T value)
+{
+	return ((value < 0) ? -value : value);
+}
+
+// Calculates the square root of an integer, rounded down
+// Works out one bit of the result at a time, so it needs no multiplication or division
+inline uint16_t squareRoot(uint32_t value)
+{
+	uint32_t result = 0;
+	uint32_t bit = (static_cast<uint32_t>(1) << 30);
+
+	// Start from the highest power of four that isn't greater than the value
+	while(bit > value)
+		bit >>= 2;
+
+	while(bit != 0)
+	{
+		if(value >= (result + bit))
+		{
+			value -= (result + bit);
+			result = ((result >> 1) + bit);
+		}
+		else
+		{
+			result >>= 1;
+		}
+
+		bit >>= 2;
+	}
+
+	return static_cast<uint16_t>(result);
+}
+
+// Calculates the square root of a fixed point number, rounded down
+inline NumberU squareRoot(NumberU value)
+{
+	// sqrt(raw / 256) * 256 == sqrt(raw * 256)
+	return NumberU::fromInternal(squareRoot(static_cast<uint32_t>(value.getInternal()) << NumberU::FractionSize));
+}
+
 template< typename T, size_t size >
 constexpr size_t arrayLength(T (&)[size])
 {
@@ -48,4 +141,38 @@ template< typename T >
 constexpr size_t arrayLength(T (&)[0])
 {
 	return 0;
+}
+
+// Selects the smallest unsigned integer type with at least the specified number of bits
+template< size_t bits, bool fits8 = (bits <= 8), bool fits16 = (bits <= 16), bool fits32 = (bits <= 32) >
+struct BitMask
+{
+	using Type = uint64_t;
+};
+
+template< size_t bits, bool fits16, bool fits32 >
+struct BitMask<bits, true, fits16, fits32>
+{
+	using Type = uint8_t;
+};
+
+template< size_t bits, bool fits32 >
+struct BitMask<bits, false, true, fits32>
+{
+	using Type = uint16_t;
+};
+
+template< size_t bits >
+struct BitMask<bits, false, false, true>
+{
+	using Type = uint32_t;
+};
+
+// Calls the function with the index of each set bit, from lowest to highest
+template< typename Mask, typename Function >
+void forEachBit(Mask mask, Function function)
+{
+	for(uint8_t index = 0; mask != 0; ++index, mask >>= 1)
+		if((mask & 1) != 0)
+			function(index);
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Adds together the value shifted right by each shift whose bit is set in the numerator,
+// where bit 7 is a shift of 1 and bit 0 is a shift of 8
+//
+// The value is shifted one place at a time, rounding down or up,
+// and the recursion stops after the lowest set bit
+template< uint8_t numerator, bool roundUp, uint8_t shift = 1, bool done = ((numerator & ((1 << (9 - shift)) - 1)) == 0) >
+struct ShiftSum
+{
+	static uint16_t sum(uint16_t value)
+	{
+		value = roundUp ? ((value + 1) >> 1) : (value >> 1);
+
+		const uint16_t term = ((numerator & (1 << (8 - shift))) != 0) ? value : 0;
+
+		return (term + ShiftSum<numerator, roundUp, shift + 1>::sum(value));
+	}
+};
+
+template< uint8_t numerator, bool roundUp, uint8_t shift >
+struct ShiftSum<numerator, roundUp, shift, true>
+{
+	static uint16_t sum(uint16_t)
+	{
+		return 0;
+	}
+};
+
+template< uint8_t value >
+constexpr uint8_t countBits()
+{
+	return (value == 0) ? 0 : ((value & 1) + countBits<(value >> 1)>());
+}
+
+// A constant fraction, numerator / 256, applied with shifts and additions instead of multiplication
+//
+// The fraction is either a sum of halves, quarters, eighths and so on,
+// or one minus such a sum, whichever needs fewer terms:
+// 0.75 is 1/2 + 1/4, and 0.95 is 1 - 1/32 - 1/64 - 1/256.
+// The terms are applied to the magnitude, so the result is always rounded towards zero.
+template< uint8_t numeratorValue >
+struct ConstantFactor
+{
+	static constexpr uint8_t numerator = numeratorValue;
+
+	// Indicates whether the fraction is applied as one minus a sum
+	static constexpr bool subtractive = ((numerator != 0) && ((countBits<static_cast<uint8_t>(256 - numerator)>() + 1) < countBits<numerator>()));
+
+	static uint16_t scaleMagnitude(uint16_t magnitude)
+	{
+		if(!subtractive)
+			return ShiftSum<numerator, false>::sum(magnitude);
+
+		// Rounding the subtracted terms up rounds the result down,
+		// but for tiny magnitudes they can add up to more than the magnitude
+		const uint16_t difference = ShiftSum<static_cast<uint8_t>(256 - numerator), true>::sum(magnitude);
+
+		return (difference < magnitude) ? (magnitude - difference) : 0;
+	}
+
+	// Scales a signed fixed point value of up to 16 bits
+	template< typename T >
+	static T scale(T value)
+	{
+		const auto internal = value.getInternal();
+		const bool negative = (internal < 0);
+
+		const uint16_t magnitude = negative ? (0u - static_cast<uint16_t>(internal)) : static_cast<uint16_t>(internal);
+		const uint16_t result = scaleMagnitude(magnitude);
+
+		return T::fromInternal(static_cast<typename T::InternalType>(negative ? (0u - result) : result));
+	}
+};
+
+// Gets the numerator of the ConstantFactor closest to, but not above, a coefficient between zero and one
+template< typename T >
+constexpr uint8_t getFactorNumerator(T coefficient)
+{
+	return numberCast<UFixed<0, 8>>(coefficient).getInternal();
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Keeps the centres of two bodies a fixed distance apart, like a rigid link
+// Bodies are referred to by their handles, so a constraint survives other bodies being despawned
+class DistanceConstraint
+{
+public:
+	// Fields
+	uint8_t first = 0;
+	uint8_t second = 0;
+	Number length = 0;
+
+public:
+	// Constructors
+	constexpr DistanceConstraint() = default;
+
+	constexpr DistanceConstraint(uint8_t first, uint8_t second, Number length) :
+		first { first },
+		second { second },
+		length { length }
+	{
+	}
+
+	constexpr bool involves(uint8_t handle) const
+	{
+		return ((this->first == handle) || (this->second == handle));
+	}
+};
+
+// A fixed number of distance constraints, such as the links of chains and ropes
+// Despawning a body leaves its constraints behind, so remove them first
+template< uint8_t capacityValue >
+class DistanceConstraints
+{
+public:
+	// Constants
+	static constexpr uint8_t capacity = capacityValue;
+
+private:
+	// Fields
+	DistanceConstraint constraints[capacity];
+	uint8_t count = 0;
+
+public:
+	void clear()
+	{
+		this->count = 0;
+	}
+
+	uint8_t getCount() const
+	{
+		return this->count;
+	}
+
+	bool isFull() const
+	{
+		return (this->count >= capacity);
+	}
+
+	const DistanceConstraint & getConstraint(uint8_t index) const
+	{
+		return this->constraints[index];
+	}
+
+	// Returns false if there's no room for the constraint
+	bool add(const DistanceConstraint & constraint)
+	{
+		if(this->isFull())
+			return false;
+
+		this->constraints[this->count] = constraint;
+		++this->count;
+		return true;
+	}
+
+	// Removes every constraint involving the body with the specified handle,
+	// moving the last constraint into the place of each one removed
+	void remove(uint8_t handle)
+	{
+		uint8_t index = 0;
+
+		while(index < this->count)
+		{
+			if(this->constraints[index].involves(handle))
+			{
+				--this->count;
+				this->constraints[index] = this->constraints[this->count];
+			}
+			else
+			{
+				++index;
+			}
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,191 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+#include "Vector.h"
+
+// A contact between two bodies that's been seen on this step,
+// along with the impulse it took to keep them apart, which carries over to the next step
+template< typename ImpulseType >
+class CachedContact
+{
+public:
+	// Types
+	using Impulse = ImpulseType;
+
+public:
+	// Fields
+
+	// The indices of the bodies, first being the lower
+	uint8_t first = 0;
+	uint8_t second = 0;
+
+	// Indicates whether the contact has been seen on the current step
+	bool touched = false;
+
+	// Indicates whether the contact was first seen on the current step
+	bool isNew = false;
+
+	// Indicates whether a listener has been told that the contact began
+	bool isReported = false;
+
+	// The direction from the first body to the second, which is found again every step
+	Vector2 normal;
+
+	// The speed at which the bodies should separate, for them to bounce
+	Impulse bias = 0;
+
+	// The total change in relative speed along the normal applied to the contact so far,
+	// which is never negative because contacts can only push
+	Impulse impulse = 0;
+
+public:
+	// Takes the bounce out of the impulse, leaving the impulse that held the bodies apart
+	void removeBias()
+	{
+		this->impulse = (this->impulse > this->bias) ? (this->impulse - this->bias) : Impulse(0);
+		this->bias = 0;
+	}
+
+	constexpr bool matches(uint8_t first, uint8_t second) const
+	{
+		return ((this->first == first) && (this->second == second));
+	}
+};
+
+// Remembers the contacts between bodies from one step to the next,
+// so that each step's solve can start from the impulses that held the bodies apart on the last one
+// (known as warm starting), which settles stacks in far fewer iterations
+//
+// Contacts are keyed by body index, so clear the cache whenever bodies are despawned.
+// Contacts that weren't seen on a step are evicted at the end of it,
+// and contacts that don't fit are still resolved, but without being remembered.
+template< uint8_t capacityValue, typename ImpulseType = Number >
+class ContactCache
+{
+public:
+	// Constants
+	static constexpr uint8_t capacity = capacityValue;
+
+	// Types
+	using Impulse = ImpulseType;
+	using Contact = CachedContact<Impulse>;
+
+private:
+	// Fields
+	Contact contacts[capacity];
+	uint8_t count = 0;
+
+public:
+	void clear()
+	{
+		this->count = 0;
+	}
+
+	uint8_t getCount() const
+	{
+		return this->count;
+	}
+
+	bool isFull() const
+	{
+		return (this->count >= capacity);
+	}
+
+	Contact & getContact(uint8_t index)
+	{
+		return this->contacts[index];
+	}
+
+	const Contact & getContact(uint8_t index) const
+	{
+		return this->contacts[index];
+	}
+
+	// Marks every contact as unseen, ready for a new step
+	void beginStep()
+	{
+		for(uint8_t index = 0; index < this->count; ++index)
+		{
+			this->contacts[index].touched = false;
+			this->contacts[index].isNew = false;
+		}
+	}
+
+	// Finds the contact between two bodies, adding it if it's new.
+	// The first index must be lower than the second.
+	// Returns nullptr if the contact is new and there's no room for it.
+	Contact * touch(uint8_t first, uint8_t second)
+	{
+		for(uint8_t index = 0; index < this->count; ++index)
+		{
+			Contact & contact = this->contacts[index];
+
+			if(contact.matches(first, second))
+			{
+				contact.touched = true;
+				return &contact;
+			}
+		}
+
+		if(this->isFull())
+			return nullptr;
+
+		Contact & contact = this->contacts[this->count];
+		++this->count;
+
+		contact.first = first;
+		contact.second = second;
+		contact.touched = true;
+		contact.isNew = true;
+		contact.isReported = false;
+		contact.impulse = 0;
+
+		return &contact;
+	}
+
+	// Removes every contact that wasn't seen on this step,
+	// moving the last contact into the place of each one removed
+	void endStep()
+	{
+		this->endStep([](const Contact &) {});
+	}
+
+	// Removes every contact that wasn't seen on this step like endStep,
+	// calling the action with each contact before it's removed
+	template< typename Action >
+	void endStep(Action action)
+	{
+		uint8_t index = 0;
+
+		while(index < this->count)
+		{
+			if(!this->contacts[index].touched)
+			{
+				action(static_cast<const Contact &>(this->contacts[index]));
+
+				--this->count;
+				this->contacts[index] = this->contacts[this->count];
+			}
+			else
+			{
+				++index;
+			}
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,267 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+
+#pragma once
+
+#include "Common.h"
+#include "Vector.h"
+
+// What a contact event is between
+enum class ContactKind : uint8_t
+{
+	// Two bodies
+	Body,
+
+	// A trigger, which is the first body, and a body overlapping it
+	Trigger,
+
+	// A body and an edge of the world
+	Edge,
+
+	// A body and a piece of static geometry, which is the second index
+	Geometry,
+};
+
+// Where a contact is in its lifetime
+enum class ContactPhase : uint8_t
+{
+	// The contact has just started
+	Begin,
+
+	// The contact was already there on the last step
+	Stay,
+
+	// The contact has just ended
+	End,
+
+	// The bodies hit each other, but the contact isn't followed,
+	// so it never stays or ends
+	Hit,
+};
+
+// Something that happened to a body during a step.
+//
+// Only contacts kept in a contact cache are followed from one step to the next,
+// so only they begin, stay and end.
+// Every other contact is a hit, and overlapping a trigger is always a stay.
+class ContactEvent
+{
+public:
+	// Fields
+	ContactKind kind = ContactKind::Body;
+	ContactPhase phase = ContactPhase::Begin;
+
+	// The index of the body, or the lower index of two bodies
+	uint8_t first = 0;
+
+	// The index of the other body or piece of geometry, which is zero for an edge
+	uint8_t second = 0;
+
+	// The direction from the first body to whatever it hit
+	Vector2 normal;
+
+	// The change in speed along the normal that the contact caused, in pixels per frame.
+	// Ends and triggers have no impulse.
+	Number impulse = 0;
+
+public:
+	// Constructors
+	constexpr ContactEvent() = default;
+
+	constexpr ContactEvent(ContactKind kind, ContactPhase phase, uint8_t first, uint8_t second, Vector2 normal, Number impulse) :
+		kind { kind }, phase { phase }, first { first }, second { second }, normal { normal }, impulse { impulse }
+	{
+	}
+};
+
+// A world's contact listener is told about every contact event as it happens,
+// through onContact, in the middle of the step.
+// Listening is decided at compile time: when isListening is false,
+// the world doesn't even work out the events.
+//
+// onContact returns false if the listener couldn't take the event.
+// A contact whose beginning wasn't taken begins again on the next step,
+// and a contact only ends if it began, so begins and ends always come in pairs.
+
+// Ignores every event, so that events cost nothing
+class NoContactListener
+{
+public:
+	static constexpr bool isListening = false;
+
+	bool onContact(const ContactEvent &)
+	{
+		return true;
+	}
+};
+
+// Keeps the events of each step in a ring buffer,
+// so that the game can drain them all once the step is over.
+//
+// Room is kept for the end of every contact that has begun,
+// so ends are never dropped, and the capacity should be more than the contact cache's.
+// When the queue is full, the newest stay gives way to any other event,
+// and otherwise the event is dropped, and counted.
+// So only stays, hits and edges are ever lost, and a beginning that's dropped is only late.
+// The capacity must be a power of two, and a capacity of zero listens to nothing.
+template< uint8_t capacityValue >
+class ContactEventQueue
+{
+public:
+	// Constants
+	static constexpr bool isListening = true;
+	static constexpr uint8_t capacity = capacityValue;
+
+private:
+	static constexpr uint8_t indexMask = (capacity - 1);
+
+	static_assert((capacity & indexMask) == 0, "The capacity must be a power of two");
+
+private:
+	// Fields
+	ContactEvent events[capacity];
+	uint8_t head = 0;
+	uint8_t count = 0;
+	uint8_t droppedCount = 0;
+
+	// The number of contacts that have begun and not yet ended,
+	// each of which keeps room for its end
+	uint8_t openCount = 0;
+
+public:
+	bool onContact(const ContactEvent & event)
+	{
+		// A beginning keeps room for its end, and an end uses the room that was kept for it
+		const uint8_t opened = (event.phase == ContactPhase::Begin) ? 1 : 0;
+		const uint8_t closed = ((event.phase == ContactPhase::End) && (this->openCount > 0)) ? 1 : 0;
+
+		// If there isn't room, any other event can take the place of a stay
+		for(uint8_t needed = ((this->count + 1 + this->openCount + opened) - closed); needed > capacity; --needed)
+			if((event.phase == ContactPhase::Stay) || !this->removeNewestStay())
+			{
+				if(this->droppedCount < UINT8_MAX)
+					++this->droppedCount;
+
+				return false;
+			}
+
+		this->events[(this->head + this->count) & indexMask] = event;
+		++this->count;
+
+		this->openCount = ((this->openCount + opened) - closed);
+
+		return true;
+	}
+
+	bool isEmpty() const
+	{
+		return (this->count == 0);
+	}
+
+	uint8_t getCount() const
+	{
+		return this->count;
+	}
+
+	// The number of events dropped since the queue was last drained or cleared,
+	// which stops counting at 255
+	uint8_t getDroppedCount() const
+	{
+		return this->droppedCount;
+	}
+
+	// Forgets every event, and the room kept for the ends of contacts that have begun
+	void clear()
+	{
+		this->head = 0;
+		this->count = 0;
+		this->droppedCount = 0;
+		this->openCount = 0;
+	}
+
+	// Calls the action with each event, oldest first, and then empties the queue
+	template< typename Action >
+	void drain(Action action)
+	{
+		for(; this->count > 0; --this->count)
+		{
+			action(static_cast<const ContactEvent &>(this->events[this->head]));
+			this->head = ((this->head + 1) & indexMask);
+		}
+
+		this->head = 0;
+		this->droppedCount = 0;
+	}
+
+private:
+	// Removes the newest stay from the queue, moving the events after it down.
+	// Returns false if there are no stays.
+	bool removeNewestStay()
+	{
+		for(uint8_t offset = this->count; offset > 0; --offset)
+		{
+			const uint8_t index = ((this->head + offset - 1) & indexMask);
+
+			if(this->events[index].phase != ContactPhase::Stay)
+				continue;
+
+			for(uint8_t next = offset; next < this->count; ++next)
+				this->events[(this->head + next - 1) & indexMask] = this->events[(this->head + next) & indexMask];
+
+			--this->count;
+
+			if(this->droppedCount < UINT8_MAX)
+				++this->droppedCount;
+
+			return true;
+		}
+
+		return false;
+	}
+};
+
+template<>
+class ContactEventQueue<0> : public NoContactListener
+{
+public:
+	static constexpr uint8_t capacity = 0;
+
+public:
+	bool isEmpty() const
+	{
+		return true;
+	}
+
+	uint8_t getCount() const
+	{
+		return 0;
+	}
+
+	uint8_t getDroppedCount() const
+	{
+		return 0;
+	}
+
+	void clear()
+	{
+	}
+
+	template< typename Action >
+	void drain(Action)
+	{
+	}
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Decides how many fixed size physics steps to simulate each frame,
+// allowing physics to run at a different rate to the display.
+//
+// Time is accumulated in whole frames rather than being read from a clock,
+// so the number of steps per frame follows an exact repeating pattern
+// (e.g. 45 steps per second at 60 frames per second is 1, 1, 1, 0).
+//
+// Velocities are measured in pixels per frame,
+// so each step covers (frameRate / stepRate) frames worth of time.
+class FixedTimestep
+{
+private:
+	// Fields
+	uint8_t frameRate;
+	uint8_t stepRate;
+	uint8_t maximumSteps;
+	uint16_t accumulator = 0;
+	Number timeStep;
+
+public:
+	// Indicates whether a step at the step rate lasts few enough frames to be a Number.
+	// The rates can be anything up to 255, as long as the frame rate is less than 128 steps' worth.
+	static constexpr bool isValidRate(uint8_t frameRate, uint8_t stepRate)
+	{
+		return ((stepRate > 0) && (frameRate < (static_cast<uint16_t>(stepRate) * 128)));
+	}
+
+private:
+	// The shift is done as uint16_t, because an int is only 16 bits on AVR
+	// and a frame rate of 128 or more would overflow it
+	static constexpr Number calculateTimeStep(uint8_t frameRate, uint8_t stepRate)
+	{
+		return Number::fromInternal((static_cast<uint16_t>(frameRate) << Number::FractionSize) / stepRate);
+	}
+
+public:
+	// Constructors
+	constexpr FixedTimestep(uint8_t frameRate, uint8_t stepRate, uint8_t maximumSteps) :
+		frameRate { frameRate },
+		stepRate { stepRate },
+		maximumSteps { maximumSteps },
+		timeStep { calculateTimeStep(frameRate, stepRate) }
+	{
+	}
+
+	constexpr uint8_t getFrameRate() const
+	{
+		return this->frameRate;
+	}
+
+	constexpr uint8_t getStepRate() const
+	{
+		return this->stepRate;
+	}
+
+	constexpr uint8_t getMaximumSteps() const
+	{
+		return this->maximumSteps;
+	}
+
+	// The length of each step, measured in frames
+	constexpr Number getTimeStep() const
+	{
+		return this->timeStep;
+	}
+
+	void setStepRate(uint8_t stepRate)
+	{
+		this->stepRate = stepRate;
+		this->timeStep = calculateTimeStep(this->frameRate, stepRate);
+	}
+
+	// Advances time by one frame and returns the number of steps to simulate.
+	//
+	// No more than stepLimit (or the maximum number of steps) are ever returned.
+	// Time that couldn't be simulated is dropped rather than carried over,
+	// so a heavy scene runs in slow motion instead of falling further and further behind.
+	uint8_t advanceFrame(uint8_t stepLimit)
+	{
+		this->accumulator += this->stepRate;
+
+		uint8_t steps = 0;
+
+		while(this->accumulator >= this->frameRate)
+		{
+			this->accumulator -= this->frameRate;
+			++steps;
+		}
+
+		if(stepLimit > this->maximumSteps)
+			stepLimit = this->maximumSteps;
+
+		return (steps < stepLimit) ? steps : stepLimit;
+	}
+
+	uint8_t advanceFrame()
+	{
+		return this->advanceFrame(this->maximumSteps);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,258 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+
+// Force fields are accelerations rather than forces,
+// so they move heavy and light bodies alike, as gravity does.
+
+// Coarse enough to square distances across an attractor's radius
+using FieldDistance = SFixed<11, 4>;
+using FieldPoint = BasicPoint2<FieldDistance>;
+
+// Pulls bodies towards a point, like a spring,
+// so the pull grows with distance until it's cut off at the radius.
+// The radius can be at most 31 pixels, so that squared distances fit.
+class Attractor
+{
+public:
+	static constexpr uint8_t maximumRadius = 31;
+
+public:
+	// Fields
+	FieldPoint centre;
+	uint8_t radius = 0;
+	UnsignedType<FieldDistance> radiusSquared;
+
+	// The acceleration for each pixel between a body's centre and the centre
+	Number stiffness;
+
+public:
+	// Constructors
+	constexpr Attractor() = default;
+
+	constexpr Attractor(FieldPoint centre, uint8_t radius, Number stiffness) :
+		centre { centre },
+		radius { (radius < maximumRadius) ? radius : maximumRadius },
+		radiusSquared { fromSigned(square(FieldDistance((radius < maximumRadius) ? radius : maximumRadius))) },
+		stiffness { stiffness }
+	{
+	}
+};
+
+// Accelerates and drags the bodies whose centres are inside a rectangle
+// The right and bottom edges are exclusive, and can be past the edge of a Number
+class WindZone
+{
+public:
+	// Fields
+	int16_t left = 0;
+	int16_t top = 0;
+	int16_t right = 0;
+	int16_t bottom = 0;
+
+	Vector2 acceleration;
+
+	// The fraction of a body's velocity kept each frame, between zero and one
+	// A drag of one leaves velocities alone
+	Number drag = 1;
+
+public:
+	// Constructors
+	constexpr WindZone() = default;
+
+	constexpr WindZone(int16_t left, int16_t top, int16_t right, int16_t bottom, Vector2 acceleration, Number drag) :
+		left { left },
+		top { top },
+		right { right },
+		bottom { bottom },
+		acceleration { acceleration },
+		drag { drag }
+	{
+	}
+
+	constexpr bool contains(int16_t x, int16_t y) const
+	{
+		return ((x >= this->left) && (x < this->right) && (y >= this->top) && (y < this->bottom));
+	}
+};
+
+// The force fields of a single kind
+template< typename Field, uint8_t capacityValue >
+class ForceFieldStore
+{
+public:
+	static constexpr uint8_t capacity = capacityValue;
+
+private:
+	Field fields[capacity];
+	uint8_t count = 0;
+
+public:
+	void clear()
+	{
+		this->count = 0;
+	}
+
+	// Returns false if there's no room for the field
+	bool add(const Field & field)
+	{
+		if(this->count >= capacity)
+			return false;
+
+		this->fields[this->count] = field;
+		++this->count;
+		return true;
+	}
+
+	uint8_t getCount() const
+	{
+		return this->count;
+	}
+
+	const Field & get(uint8_t index) const
+	{
+		return this->fields[index];
+	}
+
+	// Calls the action with each field
+	template< typename Action >
+	void forEach(Action action) const
+	{
+		for(uint8_t index = 0; index < this->count; ++index)
+			action(this->fields[index]);
+	}
+};
+
+// A kind of field that has no room for any fields,
+// which takes no space and leaves nothing to apply
+template< typename Field >
+class ForceFieldStore<Field, 0>
+{
+public:
+	static constexpr uint8_t capacity = 0;
+
+public:
+	void clear()
+	{
+	}
+
+	bool add(const Field &)
+	{
+		return false;
+	}
+
+	constexpr uint8_t getCount() const
+	{
+		return 0;
+	}
+
+	template< typename Action >
+	void forEach(Action) const
+	{
+	}
+};
+
+// The force fields registered with a world,
+// kept by kind so that each kind is applied by its own pass
+template< uint8_t attractorCapacityValue, uint8_t windZoneCapacityValue >
+class ForceFields
+{
+public:
+	static constexpr uint8_t attractorCapacity = attractorCapacityValue;
+	static constexpr uint8_t windZoneCapacity = windZoneCapacityValue;
+
+private:
+	// Uniform fields are summed as they're added,
+	// so any number of them costs the same as one
+	Vector2 uniformField { 0, 0 };
+
+	ForceFieldStore<Attractor, attractorCapacity> attractors;
+	ForceFieldStore<WindZone, windZoneCapacity> windZones;
+
+public:
+	void clear()
+	{
+		this->clearUniformFields();
+		this->attractors.clear();
+		this->windZones.clear();
+	}
+
+	void clearUniformFields()
+	{
+		this->uniformField = Vector2(0, 0);
+	}
+
+	void addUniformField(Vector2 acceleration)
+	{
+		this->uniformField += acceleration;
+	}
+
+	Vector2 getUniformField() const
+	{
+		return this->uniformField;
+	}
+
+	// Returns false if there's no room for the attractor
+	bool addAttractor(const Attractor & attractor)
+	{
+		return this->attractors.add(attractor);
+	}
+
+	uint8_t getAttractorCount() const
+	{
+		return this->attractors.getCount();
+	}
+
+	const Attractor & getAttractor(uint8_t index) const
+	{
+		return this->attractors.get(index);
+	}
+
+	// Calls the action with each attractor
+	template< typename Action >
+	void forEachAttractor(Action action) const
+	{
+		this->attractors.forEach(action);
+	}
+
+	// Returns false if there's no room for the zone
+	bool addWindZone(const WindZone & windZone)
+	{
+		return this->windZones.add(windZone);
+	}
+
+	uint8_t getWindZoneCount() const
+	{
+		return this->windZones.getCount();
+	}
+
+	const WindZone & getWindZone(uint8_t index) const
+	{
+		return this->windZones.get(index);
+	}
+
+	// Calls the action with each wind zone
+	template< typename Action >
+	void forEachWindZone(Action action) const
+	{
+		this->windZones.forEach(action);
+	}
+};
\ No newline at end of file
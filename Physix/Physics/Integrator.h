@@ -0,0 +1,52 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// Chooses how a world treats a body that's moved directly,
+// such as by a constraint, rather than by its velocity
+//
+// With a fixed time step, position Verlet (x += x - previous + a * dt * dt)
+// follows exactly the same path as symplectic Euler (v += a * dt, then x += v * dt),
+// with the velocity standing in for (x - previous) / dt.
+// The world already stores one vector besides each body's position,
+// so both integrators share the same arrays and the same integration pass,
+// and only differ in what moving a body does to its velocity.
+
+// Moving a body leaves its velocity alone,
+// so corrections can't add energy, but bodies keep pulling against constraints
+struct SymplecticEuler
+{
+	template< typename Position, typename Velocity >
+	static void correct(Position & position, Velocity &, Number correction, Number)
+	{
+		position += numberCast<Position>(correction);
+	}
+};
+
+// Moving a body without moving its previous position changes its velocity by the correction over the time step,
+// so constrained bodies stop pulling against their constraints, which keeps chains and stacks stable
+struct PositionVerlet
+{
+	template< typename Position, typename Velocity >
+	static void correct(Position & position, Velocity & velocity, Number correction, Number inverseTimeStep)
+	{
+		position += numberCast<Position>(correction);
+		velocity += numberCast<Velocity>(correction * inverseTimeStep);
+	}
+};
\ No newline at end of file
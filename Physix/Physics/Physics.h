@@ -15,8 +15,21 @@
 //
 
 #include "Common.h"
+#include "ConstantFactor.h"
 #include "Point.h"
 #include "Vector.h"
 #include "RigidBody.h"
 #include "Circle.h"
-#include "Rectangle.h"
\ No newline at end of file
+#include "Rectangle.h"
+#include "Bounds.h"
+#include "SpatialGrid.h"
+#include "BodyPool.h"
+#include "Precision.h"
+#include "ForceField.h"
+#include "Integrator.h"
+#include "Constraint.h"
+#include "ContactCache.h"
+#include "ContactEvents.h"
+#include "PhysicsWorld.h"
+#include "FixedTimestep.h"
+#include "Random.h"
\ No newline at end of file
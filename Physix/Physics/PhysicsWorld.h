@@ -0,0 +1,2013 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "RigidBody.h"
+#include "Circle.h"
+#include "Rectangle.h"
+#include "Bounds.h"
+#include "Collision.h"
+#include "SpatialGrid.h"
+#include "BodyPool.h"
+#include "Precision.h"
+#include "ForceField.h"
+#include "Integrator.h"
+#include "Constraint.h"
+#include "ContactCache.h"
+#include "ContactEvents.h"
+
+// The shapes a body can have
+enum class BodyShape : uint8_t
+{
+	Box,
+	Circle,
+};
+
+// Flags describing the state of a body
+struct BodyFlags
+{
+	static constexpr uint8_t None = 0;
+
+	// The body is immovable and is never integrated
+	static constexpr uint8_t Static = (1 << 0);
+
+	// The body has come to rest and isn't integrated until it's woken
+	static constexpr uint8_t Sleeping = (1 << 1);
+
+	// The body is outside the region being simulated,
+	// so it's held where it is, like a static body, until the region changes
+	static constexpr uint8_t Distant = (1 << 6);
+
+	// Bodies with any of these flags are skipped by every pass
+	static constexpr uint8_t Inactive = (Static | Sleeping | Distant);
+
+	// The body is a circle rather than a box
+	static constexpr uint8_t Circle = (1 << 2);
+
+	// The body is fast enough to be swept this step,
+	// so the ordinary integration skips it
+	static constexpr uint8_t Swept = (1 << 3);
+
+	// The body only notices the bodies that overlap it,
+	// and neither pushes them nor is pushed by them
+	static constexpr uint8_t Trigger = (1 << 4);
+
+	// The trigger was overlapped by a body during the last pass over collisions between bodies
+	static constexpr uint8_t Triggered = (1 << 5);
+};
+
+// The collision layers a body is on, or collides with, one bit per layer.
+// What each layer means is up to the game.
+struct CollisionLayers
+{
+	static constexpr uint8_t None = 0;
+	static constexpr uint8_t All = 0xFF;
+};
+
+// The first body that a ray hits
+class RaycastHit
+{
+public:
+	// Fields
+	uint8_t index = 0;
+
+	// How far along the ray the body was hit, as a fraction of its length
+	Number fraction = 0;
+
+	// The normal of the side that was hit, which points back along the ray
+	Vector2 normal;
+};
+
+// A piece of static geometry, which is never moved by anything.
+// Like a body, it's positioned by the top left of its bounding box,
+// and a circle's diameter is its width.
+class StaticShape
+{
+public:
+	// Fields
+	BodyShape shape = BodyShape::Box;
+	int8_t x = 0;
+	int8_t y = 0;
+	uint8_t width = 0;
+	uint8_t height = 0;
+
+public:
+	// Constructors
+	constexpr StaticShape() = default;
+
+	constexpr StaticShape(BodyShape shape, int8_t x, int8_t y, uint8_t width, uint8_t height) :
+		shape { shape },
+		x { x },
+		y { y },
+		width { width },
+		height { height }
+	{
+	}
+
+	constexpr Rectangle getBox() const
+	{
+		return Rectangle(Number(this->x), Number(this->y), this->width, this->height);
+	}
+
+	// Circles are positioned by their centres
+	constexpr Circle getCircle() const
+	{
+		return Circle(Number(this->x) + fromUnsigned(this->width * NumberU(0.5)), Number(this->y) + fromUnsigned(this->width * NumberU(0.5)), (this->width * NumberU(0.5)));
+	}
+};
+
+// Static geometry is kept apart from the bodies,
+// so that it can stay wherever it's stored, such as in flash.
+// The world reads it through any type with these functions and a Mask type,
+// and only tests a body against the shapes that getShapesNear gives for its box.
+// This one has no shapes at all.
+class NoGeometry
+{
+public:
+	using Mask = uint8_t;
+
+public:
+	constexpr uint8_t getCount() const
+	{
+		return 0;
+	}
+
+	constexpr Mask getShapesNear(int16_t, int16_t, uint8_t, uint8_t) const
+	{
+		return 0;
+	}
+
+	constexpr StaticShape getShape(uint8_t) const
+	{
+		return StaticShape();
+	}
+};
+
+// How a body's vertical velocity changes when it strays past the top or bottom edge
+
+// The velocity is reversed, so nothing is lost
+class ElasticBounce
+{
+public:
+	template< typename Velocity >
+	Velocity operator()(Velocity velocity) const
+	{
+		return -velocity;
+	}
+};
+
+// The velocity is reversed and scaled by the restitution,
+// or brought to a halt if it's slower than the threshold, so that bodies can come to rest
+// The restitution is either a coefficient or a ConstantFactor
+template< typename Factor, typename Velocity >
+class DampedBounce
+{
+public:
+	// Fields
+	Factor restitution;
+	Velocity threshold;
+
+public:
+	// Constructors
+	constexpr DampedBounce(Factor restitution, Velocity threshold) :
+		restitution { restitution },
+		threshold { threshold }
+	{
+	}
+
+	Velocity operator()(Velocity velocity) const
+	{
+		return (velocity > this->threshold) ? scaleByCoefficient(-velocity, this->restitution) : Velocity(0);
+	}
+};
+
+// A collection of bodies stored as a structure of arrays.
+//
+// Each pass only touches the arrays it needs,
+// which keeps the loops tight and saves address calculations.
+//
+// A body's position is the top left of its bounding square,
+// whatever its shape, and its size is the width of that square.
+//
+// Positions and velocities are stored in the precision's number types,
+// and are converted to and from Number at the edges of the world.
+//
+// Bodies are spawned and despawned through a pool, which keeps them packed together,
+// so every pass only loops over the bodies that are alive.
+// Bodies are accessed by their index, or slot, which changes when another body is despawned,
+// so anything that needs to refer to a body for longer should keep its handle.
+//
+// The integrator decides what moving a body directly, such as by a constraint, does to its velocity.
+//
+// The listener is told about every contact with another body, an edge or the geometry, and every trigger overlap.
+// The default listener ignores them, and then the events aren't even worked out.
+template< uint8_t capacityValue, typename PrecisionType = DefaultPrecision, typename IntegratorType = SymplecticEuler, typename ListenerType = NoContactListener >
+class PhysicsWorld
+{
+public:
+	// Constants
+	static constexpr uint8_t capacity = capacityValue;
+
+	// The number of times a swept body can bounce in a single step
+	static constexpr uint8_t maximumSweeps = 2;
+
+	using Grid = SpatialGrid<capacity>;
+	using Pool = BodyPool<capacity>;
+
+	static constexpr uint8_t invalidHandle = Pool::invalidHandle;
+
+	// Types
+	using Precision = PrecisionType;
+	using Position = typename Precision::Position;
+	using Velocity = typename Precision::Velocity;
+	using Coefficient = typename Precision::Coefficient;
+	using Integrator = IntegratorType;
+	using Listener = ListenerType;
+
+private:
+	using VelocityVector = BasicVector2<Velocity>;
+
+private:
+	// Fields
+	Position x[capacity];
+	Position y[capacity];
+	Velocity vx[capacity];
+	Velocity vy[capacity];
+	Number inverseMass[capacity];
+	uint8_t flags[capacity];
+	uint8_t sizes[capacity];
+
+	// The layers each body is on, and the layers it collides with
+	uint8_t layers[capacity];
+	uint8_t collisionMasks[capacity];
+
+	// The number of consecutive steps each body has been slower than the sleep threshold
+	uint8_t restingSteps[capacity];
+
+	// The number of contacts resolved so far, which wraps around
+	uint16_t contactCount = 0;
+
+	// The pixel that the grid's first cell starts at
+	int16_t gridX = 0;
+	int16_t gridY = 0;
+
+	Grid grid;
+	Pool pool;
+	Listener listener;
+
+public:
+	// Body lifetimes
+
+	// The number of bodies that are alive, which occupy the indices from zero up to but not including it
+	uint8_t getCount() const
+	{
+		return this->pool.getCount();
+	}
+
+	bool isFull() const
+	{
+		return this->pool.isFull();
+	}
+
+	uint8_t getIndex(uint8_t handle) const
+	{
+		return this->pool.getSlot(handle);
+	}
+
+	uint8_t getHandle(uint8_t index) const
+	{
+		return this->pool.getHandle(index);
+	}
+
+	// Returns the handle of a new body at the origin, or invalidHandle if the world is full.
+	// The new body is a stationary box of size 1 and mass 1, at the index before getCount().
+	uint8_t spawn()
+	{
+		const uint8_t handle = this->pool.allocate();
+
+		if(handle == invalidHandle)
+			return invalidHandle;
+
+		const uint8_t index = this->pool.getSlot(handle);
+
+		this->x[index] = 0;
+		this->y[index] = 0;
+		this->vx[index] = 0;
+		this->vy[index] = 0;
+		this->inverseMass[index] = 1;
+		this->flags[index] = BodyFlags::None;
+		this->sizes[index] = 1;
+		this->layers[index] = CollisionLayers::All;
+		this->collisionMasks[index] = CollisionLayers::All;
+		this->restingSteps[index] = 0;
+
+		return handle;
+	}
+
+	// Removes a body, moving the last body into its index
+	void despawn(uint8_t handle)
+	{
+		const uint8_t index = this->pool.release(handle);
+		const uint8_t last = this->pool.getCount();
+
+		if(index == last)
+			return;
+
+		this->x[index] = this->x[last];
+		this->y[index] = this->y[last];
+		this->vx[index] = this->vx[last];
+		this->vy[index] = this->vy[last];
+		this->inverseMass[index] = this->inverseMass[last];
+		this->flags[index] = this->flags[last];
+		this->sizes[index] = this->sizes[last];
+		this->layers[index] = this->layers[last];
+		this->collisionMasks[index] = this->collisionMasks[last];
+		this->restingSteps[index] = this->restingSteps[last];
+	}
+
+	// Removes every body
+	void clear()
+	{
+		this->pool.clear();
+	}
+
+	// Body accessors
+	Number getX(uint8_t index) const
+	{
+		return numberCast<Number>(this->x[index]);
+	}
+
+	Number getY(uint8_t index) const
+	{
+		return numberCast<Number>(this->y[index]);
+	}
+
+	Point2 getPosition(uint8_t index) const
+	{
+		return Point2(this->getX(index), this->getY(index));
+	}
+
+	// Note: moving a body wakes it
+	void setPosition(uint8_t index, Point2 position)
+	{
+		this->x[index] = numberCast<Position>(position.x);
+		this->y[index] = numberCast<Position>(position.y);
+		this->wake(index);
+	}
+
+	Vector2 getVelocity(uint8_t index) const
+	{
+		return Vector2(numberCast<Number>(this->vx[index]), numberCast<Number>(this->vy[index]));
+	}
+
+	// Note: changing a body's velocity wakes it
+	void setVelocity(uint8_t index, Vector2 velocity)
+	{
+		this->vx[index] = numberCast<Velocity>(velocity.x);
+		this->vy[index] = numberCast<Velocity>(velocity.y);
+		this->wake(index);
+	}
+
+	void addVelocity(uint8_t index, Vector2 velocity)
+	{
+		this->vx[index] += numberCast<Velocity>(velocity.x);
+		this->vy[index] += numberCast<Velocity>(velocity.y);
+		this->wake(index);
+	}
+
+	Number getInverseMass(uint8_t index) const
+	{
+		return this->inverseMass[index];
+	}
+
+	// Note: this makes a static body dynamic again
+	void setMass(uint8_t index, Number mass)
+	{
+		this->inverseMass[index] = (1 / mass);
+		this->flags[index] &= ~BodyFlags::Static;
+	}
+
+	// Note: this doesn't change whether the body is static, so use makeStatic for that
+	void setInverseMass(uint8_t index, Number inverseMass)
+	{
+		this->inverseMass[index] = inverseMass;
+	}
+
+	bool isStatic(uint8_t index) const
+	{
+		return ((this->flags[index] & BodyFlags::Static) != 0);
+	}
+
+	// Makes the body immovable.
+	// Static bodies have zero inverse mass and are skipped by every pass.
+	void makeStatic(uint8_t index)
+	{
+		this->vx[index] = 0;
+		this->vy[index] = 0;
+		this->inverseMass[index] = 0;
+		this->flags[index] |= BodyFlags::Static;
+	}
+
+	void setBody(uint8_t index, const RigidBody & body)
+	{
+		this->setPosition(index, body.position);
+
+		if(body.isStatic())
+		{
+			this->makeStatic(index);
+		}
+		else
+		{
+			this->setVelocity(index, body.velocity);
+			this->inverseMass[index] = body.getInverseMass();
+			this->flags[index] &= ~BodyFlags::Static;
+		}
+	}
+
+	// Static bodies have zero inverse mass, so forces have no effect on them
+	void applyForce(uint8_t index, Vector2 force)
+	{
+		const Number inverseMass = this->inverseMass[index];
+
+		this->vx[index] += numberCast<Velocity>(force.x * inverseMass);
+		this->vy[index] += numberCast<Velocity>(force.y * inverseMass);
+		this->wake(index);
+	}
+
+	BodyShape getShape(uint8_t index) const
+	{
+		return ((this->flags[index] & BodyFlags::Circle) != 0) ? BodyShape::Circle : BodyShape::Box;
+	}
+
+	uint8_t getSize(uint8_t index) const
+	{
+		return this->sizes[index];
+	}
+
+	// Note: the size is the width and height of a box, or the diameter of a circle
+	void setShape(uint8_t index, BodyShape shape, uint8_t size)
+	{
+		if(shape == BodyShape::Circle)
+			this->flags[index] |= BodyFlags::Circle;
+		else
+			this->flags[index] &= ~BodyFlags::Circle;
+
+		this->sizes[index] = size;
+		this->wake(index);
+	}
+
+	// Each body is on some of eight layers, and collides with the bodies on the layers in its mask.
+	// Two bodies are only tested against each other if each is on a layer in the other's mask,
+	// so either body can ignore the other.
+	// New bodies are on every layer and collide with every layer.
+	uint8_t getLayers(uint8_t index) const
+	{
+		return this->layers[index];
+	}
+
+	uint8_t getCollisionMask(uint8_t index) const
+	{
+		return this->collisionMasks[index];
+	}
+
+	// Note: this wakes the body, because it may now be overlapping something it ignored
+	void setLayers(uint8_t index, uint8_t layers, uint8_t collisionMask)
+	{
+		this->layers[index] = layers;
+		this->collisionMasks[index] = collisionMask;
+		this->wake(index);
+	}
+
+	// Rejecting a pair by its layers costs a couple of ANDs,
+	// so it's done before any of the narrow phase
+	bool canCollide(uint8_t first, uint8_t second) const
+	{
+		return (((this->layers[first] & this->collisionMasks[second]) != 0) && ((this->layers[second] & this->collisionMasks[first]) != 0));
+	}
+
+	bool isTrigger(uint8_t index) const
+	{
+		return ((this->flags[index] & BodyFlags::Trigger) != 0);
+	}
+
+	// A trigger is tested against the bodies on the layers in its mask, but only to notice them.
+	// Triggers are usually static, so that they stay where they're put.
+	// Note: swept bodies pass through static triggers
+	void setTrigger(uint8_t index, bool trigger)
+	{
+		if(trigger)
+			this->flags[index] |= BodyFlags::Trigger;
+		else
+			this->flags[index] &= ~(BodyFlags::Trigger | BodyFlags::Triggered);
+	}
+
+	// Indicates whether an awake body overlapped the trigger
+	// during the last pass over collisions between bodies.
+	// Sleeping bodies don't set off static triggers.
+	bool isTriggered(uint8_t index) const
+	{
+		return ((this->flags[index] & BodyFlags::Triggered) != 0);
+	}
+
+	Listener & getListener()
+	{
+		return this->listener;
+	}
+
+	const Listener & getListener() const
+	{
+		return this->listener;
+	}
+
+	// Counts every contact resolved since the world was created, wrapping around,
+	// so the number of contacts in a step is the difference between two counts.
+	uint16_t getContactCount() const
+	{
+		return this->contactCount;
+	}
+
+	bool isSleeping(uint8_t index) const
+	{
+		return ((this->flags[index] & BodyFlags::Sleeping) != 0);
+	}
+
+	void wake(uint8_t index)
+	{
+		this->flags[index] &= ~BodyFlags::Sleeping;
+		this->restingSteps[index] = 0;
+	}
+
+	// Should be called whenever something changes that
+	// might move bodies that have come to rest, such as gravity
+	void wakeAll()
+	{
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+			this->wake(index);
+	}
+
+	// Regions
+
+	// Only part of a large world needs to be simulated at once, such as the part around the screen.
+	// Bodies outside the region being simulated are distant: every pass skips them,
+	// and the bodies inside collide with them as if they were static.
+	// Distant bodies are chosen by their position when the region is set,
+	// so the region should be set again before each step.
+
+	bool isDistant(uint8_t index) const
+	{
+		return ((this->flags[index] & BodyFlags::Distant) != 0);
+	}
+
+	// Simulates only the bodies that are at least partly inside the region
+	void simulateInside(const Bounds & region)
+	{
+		this->selectRegion(region, BodyFlags::None, BodyFlags::Distant);
+	}
+
+	// Simulates only the bodies that are entirely outside the region
+	void simulateOutside(const Bounds & region)
+	{
+		this->selectRegion(region, BodyFlags::Distant, BodyFlags::None);
+	}
+
+	// Simulates every body again
+	void simulateEverywhere()
+	{
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+			this->flags[index] &= ~BodyFlags::Distant;
+	}
+
+	// The grid covers a fixed number of cells from its origin,
+	// and bodies beyond it are counted as being in its outermost cells,
+	// so it should be moved to wherever most of the simulated bodies are.
+	// The origin is rounded down to a whole cell.
+	void setGridOrigin(int16_t x, int16_t y)
+	{
+		constexpr int16_t cellMask = ~static_cast<int16_t>(Grid::cellSize - 1);
+
+		this->gridX = (x & cellMask);
+		this->gridY = (y & cellMask);
+	}
+
+	// Passes over every body
+
+	// Static, sleeping and distant bodies are skipped by every pass
+
+	void applyHorizontalAcceleration(Number acceleration)
+	{
+		accelerate(&this->vx[0], numberCast<Velocity>(acceleration));
+	}
+
+	void applyVerticalAcceleration(Number acceleration)
+	{
+		accelerate(&this->vy[0], numberCast<Velocity>(acceleration));
+	}
+
+	// Applies each kind of field in its own pass, and each field to every body at once,
+	// so no body has to check what kind of field it's in
+	template< typename Fields >
+	void applyForceFields(const Fields & fields, Number timeStep)
+	{
+		// The uniform fields are already summed,
+		// so together they're a single addition per body, like any other acceleration
+		const Vector2 uniformField = fields.getUniformField();
+
+		if(uniformField.x != 0)
+			accelerate(&this->vx[0], numberCast<Velocity>(uniformField.x * timeStep));
+
+		if(uniformField.y != 0)
+			accelerate(&this->vy[0], numberCast<Velocity>(uniformField.y * timeStep));
+
+		// A kind with no room for any fields has no pass at all
+		fields.forEachAttractor([this, timeStep](const Attractor & attractor)
+		{
+			this->attract(attractor, timeStep);
+		});
+
+		fields.forEachWindZone([this, timeStep](const WindZone & windZone)
+		{
+			this->blow(windZone, timeStep);
+		});
+	}
+
+	// Note: coefficients must be between zero and one
+	void applyHorizontalFriction(Number coefficient)
+	{
+		scale(&this->vx[0], numberCast<Coefficient>(coefficient));
+	}
+
+	// Note: coefficients must be between zero and one
+	void applyVerticalFriction(Number coefficient)
+	{
+		scale(&this->vy[0], numberCast<Coefficient>(coefficient));
+	}
+
+	template< uint8_t numerator >
+	void applyHorizontalFriction(ConstantFactor<numerator> coefficient)
+	{
+		scale(&this->vx[0], coefficient);
+	}
+
+	template< uint8_t numerator >
+	void applyVerticalFriction(ConstantFactor<numerator> coefficient)
+	{
+		scale(&this->vy[0], coefficient);
+	}
+
+	// The boundaries are edges: each body's size is taken into account,
+	// and they're integers so that the right edge of the screen can be represented
+
+	// Keeps every body on screen in a single pass over the bodies,
+	// reversing a body's horizontal velocity when it strays past the left or right,
+	// and passing its vertical velocity through the bounce when it strays past the top or bottom
+	template< typename VerticalBounce >
+	void bounceOffEdges(int16_t left, int16_t top, int16_t right, int16_t bottom, VerticalBounce verticalBounce)
+	{
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			if((this->flags[index] & BodyFlags::Inactive) != 0)
+				continue;
+
+			const uint8_t size = this->sizes[index];
+
+			const Position maximumX = (right - size);
+
+			if(this->x[index] < left)
+			{
+				this->x[index] = Position(left);
+				this->reportEdge(index, Vector2(-1, 0), this->vx[index], -this->vx[index]);
+				this->vx[index] = -this->vx[index];
+			}
+
+			if(this->x[index] > maximumX)
+			{
+				this->x[index] = maximumX;
+				this->reportEdge(index, Vector2(1, 0), this->vx[index], -this->vx[index]);
+				this->vx[index] = -this->vx[index];
+			}
+
+			const Position maximumY = (bottom - size);
+
+			if(this->y[index] < top)
+			{
+				const Velocity bounced = verticalBounce(this->vy[index]);
+
+				this->y[index] = Position(top);
+				this->reportEdge(index, Vector2(0, -1), this->vy[index], bounced);
+				this->vy[index] = bounced;
+			}
+
+			if(this->y[index] > maximumY)
+			{
+				const Velocity bounced = verticalBounce(this->vy[index]);
+
+				this->y[index] = maximumY;
+				this->reportEdge(index, Vector2(0, 1), this->vy[index], bounced);
+				this->vy[index] = bounced;
+			}
+		}
+	}
+
+	// Reverses velocities on every edge
+	void bounceOffEdges(int16_t left, int16_t top, int16_t right, int16_t bottom)
+	{
+		this->bounceOffEdges(left, top, right, bottom, ElasticBounce());
+	}
+
+	// Scales vertical velocities by the restitution on the top and bottom edges,
+	// or brings them to a halt if they're slower than the threshold
+	void bounceOffEdges(int16_t left, int16_t top, int16_t right, int16_t bottom, Number restitution, Number threshold)
+	{
+		this->bounceOffEdges(left, top, right, bottom, DampedBounce<Coefficient, Velocity>(numberCast<Coefficient>(restitution), numberCast<Velocity>(threshold)));
+	}
+
+	template< uint8_t numerator >
+	void bounceOffEdges(int16_t left, int16_t top, int16_t right, int16_t bottom, ConstantFactor<numerator> restitution, Number threshold)
+	{
+		this->bounceOffEdges(left, top, right, bottom, DampedBounce<ConstantFactor<numerator>, Velocity>(restitution, numberCast<Velocity>(threshold)));
+	}
+
+	// Moves every body according to its velocity
+	void integrate()
+	{
+		integrate(&this->x[0], &this->vx[0], BodyFlags::Inactive);
+		integrate(&this->y[0], &this->vy[0], BodyFlags::Inactive);
+	}
+
+	// Moves every body according to its velocity over the specified length of time
+	void integrate(Number timeStep)
+	{
+		// The common case avoids a multiplication per body
+		if(timeStep == 1)
+		{
+			this->integrate();
+			return;
+		}
+
+		integrate(&this->x[0], &this->vx[0], numberCast<Velocity>(timeStep), BodyFlags::Inactive);
+		integrate(&this->y[0], &this->vy[0], numberCast<Velocity>(timeStep), BodyFlags::Inactive);
+	}
+
+	// Moves every body according to its velocity over the specified length of time.
+	//
+	// Bodies moving faster than the threshold on either axis could otherwise pass through
+	// static bodies, or end up well beyond the edges, in a single step.
+	// They're swept instead: each one stops where it would first touch an edge or a static body,
+	// bounces off it, scaled by the restitution, and carries on for the rest of the step.
+	// Static bodies and geometry are treated as boxes, whatever their shape.
+	void integrate(Number timeStep, Number threshold, int16_t left, int16_t top, int16_t right, int16_t bottom, Number restitution)
+	{
+		this->integrate(timeStep, threshold, left, top, right, bottom, restitution, NoGeometry());
+	}
+
+	template< typename Geometry >
+	void integrate(Number timeStep, Number threshold, int16_t left, int16_t top, int16_t right, int16_t bottom, Number restitution, const Geometry & geometry)
+	{
+		const Velocity velocityThreshold = numberCast<Velocity>(threshold);
+
+		// Find the bodies to sweep and the bodies they could hit
+		typename Grid::Mask sweptMask = 0;
+		typename Grid::Mask staticMask = 0;
+
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			uint8_t & flags = this->flags[index];
+
+			// Static triggers aren't in the way of anything
+			if((flags & BodyFlags::Static) != 0)
+			{
+				if((flags & BodyFlags::Trigger) == 0)
+					staticMask |= Grid::getMask(index);
+
+				continue;
+			}
+
+			if((flags & BodyFlags::Inactive) != 0)
+				continue;
+
+			if((absolute(this->vx[index]) >= velocityThreshold) || (absolute(this->vy[index]) >= velocityThreshold))
+			{
+				flags |= BodyFlags::Swept;
+				sweptMask |= Grid::getMask(index);
+			}
+		}
+
+		// Integrate everything else as usual
+		constexpr uint8_t skippedFlags = (BodyFlags::Inactive | BodyFlags::Swept);
+
+		if(timeStep == 1)
+		{
+			integrate(&this->x[0], &this->vx[0], skippedFlags);
+			integrate(&this->y[0], &this->vy[0], skippedFlags);
+		}
+		else
+		{
+			integrate(&this->x[0], &this->vx[0], numberCast<Velocity>(timeStep), skippedFlags);
+			integrate(&this->y[0], &this->vy[0], numberCast<Velocity>(timeStep), skippedFlags);
+		}
+
+		forEachBit(sweptMask, [this, timeStep, left, top, right, bottom, restitution, staticMask, &geometry](uint8_t index)
+		{
+			this->flags[index] &= ~BodyFlags::Swept;
+			this->sweep(index, timeStep, left, top, right, bottom, restitution, staticMask, geometry);
+		});
+	}
+
+	// Puts to sleep any body that has been slower than the threshold
+	// on both axes for the specified number of consecutive steps
+	void updateSleep(Number threshold, uint8_t steps)
+	{
+		const Velocity velocityThreshold = numberCast<Velocity>(threshold);
+
+		uint8_t * flags = &this->flags[0];
+		uint8_t * restingSteps = &this->restingSteps[0];
+		Velocity * vx = &this->vx[0];
+		Velocity * vy = &this->vy[0];
+
+		for(uint8_t count = this->getCount(); count > 0; --count, ++flags, ++restingSteps, ++vx, ++vy)
+		{
+			if((*flags & BodyFlags::Inactive) != 0)
+				continue;
+
+			if((absolute(*vx) >= velocityThreshold) || (absolute(*vy) >= velocityThreshold))
+			{
+				*restingSteps = 0;
+				continue;
+			}
+
+			++*restingSteps;
+
+			if(*restingSteps >= steps)
+			{
+				*vx = 0;
+				*vy = 0;
+				*flags |= BodyFlags::Sleeping;
+			}
+		}
+	}
+
+	// Moves each pair of constrained bodies towards its length, again and again for the number of iterations,
+	// so that chains of constraints settle towards every length at once.
+	// Each body moves by its share of the inverse mass, so static bodies are anchors.
+	template< uint8_t iterations, typename Constraints >
+	void solveConstraints(const Constraints & constraints, Number timeStep)
+	{
+		const uint8_t constraintCount = constraints.getCount();
+		const Number inverseTimeStep = (1 / timeStep);
+
+		for(uint8_t iteration = 0; iteration < iterations; ++iteration)
+			for(uint8_t index = 0; index < constraintCount; ++index)
+				this->solveConstraint(constraints.getConstraint(index), inverseTimeStep);
+	}
+
+	// Finds and resolves collisions between bodies,
+	// with the restitution deciding how much they bounce off each other
+	void resolveCollisions(Number restitution)
+	{
+		// Convert the restitution once rather than for every collision.
+		// It isn't a Coefficient because it may be one.
+		const Velocity bounciness = (1 + numberCast<Velocity>(restitution));
+
+		this->forEachCandidatePair([this, bounciness](uint8_t first, uint8_t second)
+		{
+			this->resolveCollision(first, second, bounciness);
+		});
+	}
+
+	// Finds and resolves collisions between bodies like resolveCollisions,
+	// but keeps each contact's impulse in the cache from one step to the next.
+	// Each contact starts from the impulse it needed on the last step,
+	// then all of the contacts are solved together the specified number of times,
+	// so that stacks come to rest with only one or two iterations.
+	// Only new contacts bounce, and only if they hit faster than the threshold,
+	// so bodies resting on each other don't jitter.
+	template< uint8_t iterations, typename Cache >
+	void resolveCollisions(Cache & cache, Number restitution, Number threshold)
+	{
+		const Velocity coefficient = numberCast<Velocity>(restitution);
+		const Velocity bounceThreshold = numberCast<Velocity>(threshold);
+
+		cache.beginStep();
+
+		this->forEachCandidatePair([this, &cache, coefficient, bounceThreshold](uint8_t first, uint8_t second)
+		{
+			this->resolveCachedCollision(cache, first, second, coefficient, bounceThreshold);
+		});
+
+		using Contact = typename Cache::Contact;
+
+		// Keep the contacts between bodies that are held still by the region being simulated,
+		// as they were, for when the bodies are simulated again
+		const uint8_t heldCount = cache.getCount();
+
+		for(uint8_t index = 0; index < heldCount; ++index)
+		{
+			Contact & contact = cache.getContact(index);
+
+			if(this->isHeld(contact.first, contact.second))
+				contact.touched = true;
+		}
+
+		// Forget the contacts that have separated
+		cache.endStep([this](const Contact & contact)
+		{
+			this->reportEnd(contact);
+		});
+
+		const uint8_t cachedCount = cache.getCount();
+
+		for(uint8_t iteration = 0; iteration < iterations; ++iteration)
+			for(uint8_t index = 0; index < cachedCount; ++index)
+			{
+				Contact & contact = cache.getContact(index);
+
+				if(!this->isHeld(contact.first, contact.second))
+					this->solveContact(contact);
+			}
+
+		// Only remember the impulse that held the bodies apart, not the impulse that bounced them,
+		// or the next step would bounce them again
+		for(uint8_t index = 0; index < cachedCount; ++index)
+		{
+			Contact & contact = cache.getContact(index);
+
+			if(this->isHeld(contact.first, contact.second))
+				continue;
+
+			// A contact keeps beginning until the listener has been told it began
+			if(Listener::isListening)
+			{
+				const ContactPhase phase = contact.isReported ? ContactPhase::Stay : ContactPhase::Begin;
+
+				if(this->report(ContactEvent(ContactKind::Body, phase, contact.first, contact.second, contact.normal, numberCast<Number>(contact.impulse))))
+					contact.isReported = true;
+			}
+
+			contact.removeBias();
+		}
+	}
+
+	// Forgets every contact in the cache, ending the ones the listener was told had begun.
+	// Use this rather than clearing the cache, so that the listener never misses an end.
+	template< typename Cache >
+	void forgetContacts(Cache & cache)
+	{
+		const uint8_t count = cache.getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+			this->reportEnd(cache.getContact(index));
+
+		cache.clear();
+	}
+
+	// Finds and resolves collisions between bodies and static geometry.
+	// Static and sleeping bodies are skipped,
+	// and each body is only tested against the shapes near it.
+	template< typename Geometry >
+	void resolveCollisions(const Geometry & geometry, Number restitution)
+	{
+		const uint8_t count = this->getCount();
+		const Velocity bounciness = (1 + numberCast<Velocity>(restitution));
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			if((this->flags[index] & BodyFlags::Inactive) != 0)
+				continue;
+
+			const uint8_t size = this->sizes[index];
+			const auto nearby = geometry.getShapesNear(static_cast<int16_t>(this->x[index]), static_cast<int16_t>(this->y[index]), size, size);
+
+			forEachBit(nearby, [this, index, bounciness, &geometry](uint8_t shape)
+			{
+				Manifold manifold;
+
+				if(this->collide(geometry.getShape(shape), index, manifold))
+					this->resolveStaticCollision(index, shape, manifold, bounciness);
+			});
+		}
+	}
+
+	// Queries
+
+	// The queries find bodies through the broad phase's grid,
+	// so they only test the bodies in the cells they cover, rather than every body.
+	// The grid is built by each pass over collisions between bodies, or by updateGrid.
+	// It's built from whole pixels, and bodies move by less than a pixel between then and the end of the step,
+	// so the queries look two pixels further to allow for both.
+	// Only bodies on at least one of the specified layers are found.
+
+	// Rebuilds the grid from where the bodies are now,
+	// such as after moving or spawning bodies outside of a step
+	void updateGrid()
+	{
+		this->grid.clear();
+
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+			this->insertIntoGrid(index);
+	}
+
+	// Writes the indices of the bodies that overlap the box to the array, up to its size.
+	// Returns the number of indices written.
+	template< uint8_t size >
+	uint8_t queryAABB(Rectangle box, uint8_t (&indices)[size], uint8_t layers = CollisionLayers::All) const
+	{
+		// The box may not start on a whole pixel, so it can cover one more pixel than its size,
+		// as well as the pixels looked further on each side
+		const auto boxWidth = static_cast<uint8_t>(box.getWidth());
+		const auto boxHeight = static_cast<uint8_t>(box.getHeight());
+		const uint8_t width = (boxWidth < (UINT8_MAX - 5)) ? (boxWidth + 5) : UINT8_MAX;
+		const uint8_t height = (boxHeight < (UINT8_MAX - 5)) ? (boxHeight + 5) : UINT8_MAX;
+
+		const auto candidates = this->getGridOccupants(static_cast<int16_t>(box.getX()) - 2, static_cast<int16_t>(box.getY()) - 2, width, height);
+
+		uint8_t found = 0;
+
+		forEachBit(candidates, [this, box, layers, &indices, &found](uint8_t index)
+		{
+			if((found < size) && this->isQueryable(index, layers) && this->overlaps(index, box))
+			{
+				indices[found] = index;
+				++found;
+			}
+		});
+
+		return found;
+	}
+
+	// Writes the indices of the bodies that the point is in to the array, up to its size.
+	// Returns the number of indices written.
+	template< uint8_t size >
+	uint8_t queryPoint(Point2 point, uint8_t (&indices)[size], uint8_t layers = CollisionLayers::All) const
+	{
+		const auto candidates = this->getGridOccupants(static_cast<int16_t>(point.x) - 2, static_cast<int16_t>(point.y) - 2, 5, 5);
+
+		uint8_t found = 0;
+
+		forEachBit(candidates, [this, point, layers, &indices, &found](uint8_t index)
+		{
+			if((found < size) && this->isQueryable(index, layers) && this->contains(index, point))
+			{
+				indices[found] = index;
+				++found;
+			}
+		});
+
+		return found;
+	}
+
+	// Finds the first body hit by a ray from the origin along the displacement.
+	// Returns false if the ray doesn't hit anything.
+	//
+	// The ray walks through the grid a cell at a time along its longer axis,
+	// testing the bodies in each cell it passes through,
+	// and stops at the first cell that has a hit closer than the cell's far side.
+	// Bodies that the ray starts inside are ignored, so a ray can be cast from inside a body.
+	// Circles are treated as boxes, as they are by sweeps.
+	// The end of the ray must be within the range of a Number.
+	bool raycast(Point2 origin, Vector2 displacement, RaycastHit & hit, uint8_t layers = CollisionLayers::All) const
+	{
+		const bool alongX = (absolute(displacement.x) >= absolute(displacement.y));
+
+		// The slope along the longer axis is at most one, so it can't overflow
+		const Number majorStart = alongX ? origin.x : origin.y;
+		const Number minorStart = alongX ? origin.y : origin.x;
+		const Number majorDisplacement = alongX ? displacement.x : displacement.y;
+		const Number minorDisplacement = alongX ? displacement.y : displacement.x;
+
+		if(majorDisplacement == 0)
+			return false;
+
+		const Number slope = (minorDisplacement / majorDisplacement);
+		const Number majorEnd = (majorStart + majorDisplacement);
+		const Number lowest = (majorDisplacement > 0) ? majorStart : majorEnd;
+		const Number highest = (majorDisplacement > 0) ? majorEnd : majorStart;
+
+		const int16_t firstCell = (static_cast<int16_t>(majorStart) >> Grid::cellShift);
+		const int16_t lastCell = (static_cast<int16_t>(majorEnd) >> Grid::cellShift);
+		const int8_t direction = (majorDisplacement > 0) ? 1 : -1;
+
+		const Rectangle ray = Rectangle(origin, 0, 0);
+		const uint8_t count = this->getCount();
+
+		typename Grid::Mask tested = 0;
+		bool found = false;
+
+		for(int16_t cell = firstCell; ; cell += direction)
+		{
+			// The part of the ray inside this cell, along the longer axis
+			const int16_t cellStart = (cell * Grid::cellSize);
+			const int16_t cellEnd = (cellStart + Grid::cellSize);
+
+			const Number segmentStart = (cellStart > static_cast<int16_t>(lowest)) ? Number(cellStart) : lowest;
+			const Number segmentEnd = (cellEnd <= static_cast<int16_t>(highest)) ? Number(cellEnd) : highest;
+
+			// And the part of the shorter axis it crosses
+			const Number minorA = (minorStart + ((segmentStart - majorStart) * slope));
+			const Number minorB = (minorStart + ((segmentEnd - majorStart) * slope));
+			const Number minorLowest = (minorA < minorB) ? minorA : minorB;
+			const Number minorHighest = (minorA < minorB) ? minorB : minorA;
+
+			const int16_t majorPixel = (static_cast<int16_t>(segmentStart) - 2);
+			const int16_t minorPixel = (static_cast<int16_t>(minorLowest) - 2);
+			const auto majorPixels = static_cast<uint8_t>(static_cast<int16_t>(segmentEnd) - majorPixel + 3);
+			const auto minorPixels = static_cast<uint8_t>(static_cast<int16_t>(minorHighest) - minorPixel + 3);
+
+			const auto occupants = alongX ?
+				this->getGridOccupants(majorPixel, minorPixel, majorPixels, minorPixels) :
+				this->getGridOccupants(minorPixel, majorPixel, minorPixels, majorPixels);
+
+			const auto candidates = (occupants & ~tested);
+			tested |= candidates;
+
+			forEachBit(candidates, [this, ray, displacement, layers, count, &hit, &found](uint8_t index)
+			{
+				if((index >= count) || !this->isQueryable(index, layers))
+					return;
+
+				Number time;
+				Vector2 normal;
+
+				if(!::sweep(ray, displacement, this->getBox(index), time, normal))
+					return;
+
+				if(found && (time >= hit.fraction))
+					return;
+
+				hit.index = index;
+				hit.fraction = time;
+				hit.normal = normal;
+				found = true;
+			});
+
+			// Any body that hasn't been tested yet can only be hit beyond this cell
+			const Number farSide = (majorDisplacement > 0) ? (segmentEnd - majorStart) : (majorStart - segmentStart);
+
+			if(found && ((hit.fraction * absolute(majorDisplacement)) <= farSide))
+				return true;
+
+			if(cell == lastCell)
+				return found;
+		}
+	}
+
+private:
+	// Calls the action with each pair of bodies that might be colliding,
+	// the lower index first.
+	// Pairs that ignore each other's layers are left out,
+	// and pairs with a trigger are only tested for overlap.
+	template< typename Action >
+	void forEachCandidatePair(Action action)
+	{
+		// Add each body to the broad phase,
+		// remembering which bodies are still moving
+		this->grid.clear();
+
+		typename Grid::Mask activeMask = 0;
+
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			this->flags[index] &= ~BodyFlags::Triggered;
+
+			this->insertIntoGrid(index);
+
+			if((this->flags[index] & BodyFlags::Inactive) == 0)
+				activeMask |= Grid::getMask(index);
+		}
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			// Bodies are added to the grid by their whole pixels,
+			// so look one pixel further around each body, or bodies overlapping by less than a pixel could be missed
+			const uint8_t size = this->sizes[index];
+			const auto occupants = this->getGridOccupants(static_cast<int16_t>(this->x[index]) - 1, static_cast<int16_t>(this->y[index]) - 1, size + 2, size + 2);
+
+			// Each pair is only tested once, and only if the bodies share a cell
+			auto candidates = (occupants & Grid::getMaskAfter(index));
+
+			// Two bodies that aren't moving can't start colliding
+			if((this->flags[index] & BodyFlags::Inactive) != 0)
+				candidates &= activeMask;
+
+			forEachBit(candidates, [this, &action, index](uint8_t other)
+			{
+				if(!this->canCollide(index, other))
+					return;
+
+				if(((this->flags[index] | this->flags[other]) & BodyFlags::Trigger) != 0)
+					this->detectTrigger(index, other);
+				else
+					action(index, other);
+			});
+		}
+	}
+
+	// Adds a body to the grid by the pixels it covers
+	void insertIntoGrid(uint8_t index)
+	{
+		const uint8_t size = this->sizes[index];
+
+		this->grid.insert(index, static_cast<int16_t>(this->x[index]) - this->gridX, static_cast<int16_t>(this->y[index]) - this->gridY, size, size);
+	}
+
+	// Returns the bodies sharing at least one cell with the specified pixels
+	typename Grid::Mask getGridOccupants(int16_t x, int16_t y, uint8_t width, uint8_t height) const
+	{
+		return this->grid.getOccupants(x - this->gridX, y - this->gridY, width, height);
+	}
+
+	// Sets one set of flags on the bodies that overlap the region, and the other on the rest,
+	// replacing whether they were distant
+	void selectRegion(const Bounds & region, uint8_t insideFlags, uint8_t outsideFlags)
+	{
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			const uint8_t size = this->sizes[index];
+			const bool inside = region.overlaps(static_cast<int16_t>(this->x[index]), static_cast<int16_t>(this->y[index]), size, size);
+
+			this->flags[index] = ((this->flags[index] & ~BodyFlags::Distant) | (inside ? insideFlags : outsideFlags));
+		}
+	}
+
+	// Indicates whether neither body of a pair is simulated,
+	// because at least one of them is outside the region being simulated
+	bool isHeld(uint8_t first, uint8_t second) const
+	{
+		const uint8_t firstFlags = this->flags[first];
+		const uint8_t secondFlags = this->flags[second];
+
+		return
+			((firstFlags & BodyFlags::Inactive) != 0) &&
+			((secondFlags & BodyFlags::Inactive) != 0) &&
+			(((firstFlags | secondFlags) & BodyFlags::Distant) != 0);
+	}
+
+	// Indicates whether a query should look at a body
+	bool isQueryable(uint8_t index, uint8_t layers) const
+	{
+		return ((this->layers[index] & layers) != 0);
+	}
+
+	// Indicates whether a body overlaps a box, including touching it
+	bool overlaps(uint8_t index, Rectangle box) const
+	{
+		if(!::intersects(box, this->getBox(index)))
+			return false;
+
+		if((this->flags[index] & BodyFlags::Circle) == 0)
+			return true;
+
+		Manifold manifold;
+
+		return ::collide(box, this->getCircle(index), manifold);
+	}
+
+	// Indicates whether a point is inside a body, or on its edge
+	bool contains(uint8_t index, Point2 point) const
+	{
+		// The box is tested first even for circles,
+		// because squaring the distance to a far away point can overflow
+		if(!this->getBox(index).intersects(point))
+			return false;
+
+		if((this->flags[index] & BodyFlags::Circle) == 0)
+			return true;
+
+		return this->getCircle(index).intersects(point);
+	}
+
+	// Marks whichever of the bodies are triggers as triggered, if the bodies overlap
+	void detectTrigger(uint8_t first, uint8_t second)
+	{
+		Manifold manifold;
+
+		if(!this->collide(first, second, manifold))
+			return;
+
+		if((this->flags[first] & BodyFlags::Trigger) != 0)
+		{
+			this->flags[first] |= BodyFlags::Triggered;
+			this->report(ContactEvent(ContactKind::Trigger, ContactPhase::Stay, first, second, manifold.normal, 0));
+		}
+
+		if((this->flags[second] & BodyFlags::Trigger) != 0)
+		{
+			this->flags[second] |= BodyFlags::Triggered;
+			this->report(ContactEvent(ContactKind::Trigger, ContactPhase::Stay, second, first, Vector2(-manifold.normal.x, -manifold.normal.y), 0));
+		}
+	}
+
+	// Tells the listener about an event, if it's listening.
+	// Returns false if the listener couldn't take it.
+	bool report(const ContactEvent & event)
+	{
+		return (Listener::isListening) ? this->listener.onContact(event) : true;
+	}
+
+	// Tells the listener that a cached contact has ended, if it was told the contact began
+	template< typename Contact >
+	void reportEnd(const Contact & contact)
+	{
+		if(contact.isReported)
+			this->report(ContactEvent(ContactKind::Body, ContactPhase::End, contact.first, contact.second, contact.normal, 0));
+	}
+
+	// Tells the listener about a body hitting an edge,
+	// from the body's speed along the edge's axis before and after it bounced
+	void reportEdge(uint8_t index, Vector2 normal, Velocity before, Velocity after)
+	{
+		if(Listener::isListening)
+			this->listener.onContact(ContactEvent(ContactKind::Edge, ContactPhase::Hit, index, 0, normal, numberCast<Number>(absolute(after - before))));
+	}
+
+	void accelerate(Velocity * velocity, Velocity acceleration) const
+	{
+		const uint8_t * flags = &this->flags[0];
+
+		for(uint8_t count = this->getCount(); count > 0; --count, ++velocity)
+			if((*flags++ & BodyFlags::Inactive) == 0)
+				*velocity += acceleration;
+	}
+
+	// Bodies are only attracted while their centres are within the radius
+	void attract(const Attractor & attractor, Number timeStep)
+	{
+		const Number gain = (attractor.stiffness * timeStep);
+		const FieldDistance radius = FieldDistance(attractor.radius);
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			if((this->flags[index] & BodyFlags::Inactive) != 0)
+				continue;
+
+			const FieldDistance halfSize = FieldDistance(this->sizes[index] / 2);
+			const FieldPoint centre = FieldPoint(numberCast<FieldDistance>(this->x[index]) + halfSize, numberCast<FieldDistance>(this->y[index]) + halfSize);
+
+			const FieldDistance offsetX = (attractor.centre.x - centre.x);
+			const FieldDistance offsetY = (attractor.centre.y - centre.y);
+
+			// Rule out distant bodies one axis at a time first,
+			// so that squaring the distance can't overflow
+			if((absolute(offsetX) >= radius) || (absolute(offsetY) >= radius))
+				continue;
+
+			if(distanceSquared(attractor.centre, centre) >= attractor.radiusSquared)
+				continue;
+
+			this->vx[index] += numberCast<Velocity>(numberCast<Number>(offsetX) * gain);
+			this->vy[index] += numberCast<Velocity>(numberCast<Number>(offsetY) * gain);
+		}
+	}
+
+	// Bodies are only blown about while their centres are inside the zone
+	void blow(const WindZone & windZone, Number timeStep)
+	{
+		const Velocity accelerationX = numberCast<Velocity>(windZone.acceleration.x * timeStep);
+		const Velocity accelerationY = numberCast<Velocity>(windZone.acceleration.y * timeStep);
+
+		// Scaled to the length of the step in the same way as friction
+		const bool dragged = (windZone.drag < 1);
+		const Coefficient drag = dragged ? numberCast<Coefficient>(1 - ((1 - windZone.drag) * timeStep)) : Coefficient();
+
+		const uint8_t count = this->getCount();
+
+		for(uint8_t index = 0; index < count; ++index)
+		{
+			if((this->flags[index] & BodyFlags::Inactive) != 0)
+				continue;
+
+			const uint8_t halfSize = (this->sizes[index] / 2);
+
+			if(!windZone.contains(static_cast<int16_t>(this->x[index]) + halfSize, static_cast<int16_t>(this->y[index]) + halfSize))
+				continue;
+
+			if(dragged)
+			{
+				this->vx[index] = scaleByCoefficient(this->vx[index], drag);
+				this->vy[index] = scaleByCoefficient(this->vy[index], drag);
+			}
+
+			this->vx[index] += accelerationX;
+			this->vy[index] += accelerationY;
+		}
+	}
+
+	// The coefficient is either a Coefficient or a ConstantFactor
+	template< typename Factor >
+	void scale(Velocity * velocity, Factor coefficient) const
+	{
+		const uint8_t * flags = &this->flags[0];
+
+		for(uint8_t count = this->getCount(); count > 0; --count, ++velocity)
+			if((*flags++ & BodyFlags::Inactive) == 0)
+				*velocity = scaleByCoefficient(*velocity, coefficient);
+	}
+
+	void integrate(Position * position, const Velocity * velocity, uint8_t skippedFlags) const
+	{
+		const uint8_t * flags = &this->flags[0];
+
+		for(uint8_t count = this->getCount(); count > 0; --count, ++position, ++velocity)
+			if((*flags++ & skippedFlags) == 0)
+				*position += numberCast<Position>(*velocity);
+	}
+
+	void integrate(Position * position, const Velocity * velocity, Velocity timeStep, uint8_t skippedFlags) const
+	{
+		const uint8_t * flags = &this->flags[0];
+
+		for(uint8_t count = this->getCount(); count > 0; --count, ++position, ++velocity)
+			if((*flags++ & skippedFlags) == 0)
+				*position += numberCast<Position>(*velocity * timeStep);
+	}
+
+	// Moves a body along its velocity for the length of the step,
+	// bouncing off the first edge, static body or piece of geometry in its way each time
+	template< typename Mask, typename Geometry >
+	void sweep(uint8_t index, Number timeStep, int16_t left, int16_t top, int16_t right, int16_t bottom, Number restitution, Mask staticMask, const Geometry & geometry)
+	{
+		const uint8_t size = this->sizes[index];
+
+		// The part of the step, in frames, that's yet to be moved through
+		Number remaining = timeStep;
+
+		for(uint8_t count = maximumSweeps; count > 0; --count)
+		{
+			const Vector2 velocity = this->getVelocity(index);
+			const Vector2 displacement = (velocity * remaining);
+
+			Number time = 1;
+			Vector2 normal;
+			bool hit = false;
+
+			// What was hit, for the listener
+			ContactKind hitKind = ContactKind::Edge;
+			uint8_t hitIndex = 0;
+
+			if(sweepEdge(this->getX(index), displacement.x, left, (right - size), time))
+			{
+				normal = Vector2((displacement.x > 0) ? -1 : 1, 0);
+				hit = true;
+			}
+
+			if(sweepEdge(this->getY(index), displacement.y, top, (bottom - size), time))
+			{
+				normal = Vector2(0, (displacement.y > 0) ? -1 : 1);
+				hit = true;
+			}
+
+			const Rectangle box = this->getBox(index);
+
+			forEachBit(staticMask, [this, index, box, displacement, &time, &normal, &hit, &hitKind, &hitIndex](uint8_t other)
+			{
+				if(!this->canCollide(index, other))
+					return;
+
+				Number otherTime;
+				Vector2 otherNormal;
+
+				if(::sweep(box, displacement, this->getBox(other), otherTime, otherNormal) && (otherTime < time))
+				{
+					time = otherTime;
+					normal = otherNormal;
+					hit = true;
+					hitKind = ContactKind::Body;
+					hitIndex = other;
+				}
+			});
+
+			// Only the shapes near the path of the body can be in its way
+			const Number pathX = (displacement.x < 0) ? (box.getLeft() + displacement.x) : box.getLeft();
+			const Number pathY = (displacement.y < 0) ? (box.getTop() + displacement.y) : box.getTop();
+			const uint8_t pathWidth = (size + static_cast<uint8_t>(absolute(displacement.x)) + 1);
+			const uint8_t pathHeight = (size + static_cast<uint8_t>(absolute(displacement.y)) + 1);
+
+			const auto nearby = geometry.getShapesNear(static_cast<int16_t>(pathX), static_cast<int16_t>(pathY), pathWidth, pathHeight);
+
+			forEachBit(nearby, [box, displacement, &time, &normal, &hit, &hitKind, &hitIndex, &geometry](uint8_t shape)
+			{
+				Number shapeTime;
+				Vector2 shapeNormal;
+
+				if(::sweep(box, displacement, geometry.getShape(shape).getBox(), shapeTime, shapeNormal) && (shapeTime < time))
+				{
+					time = shapeTime;
+					normal = shapeNormal;
+					hit = true;
+					hitKind = ContactKind::Geometry;
+					hitIndex = shape;
+				}
+			});
+
+			// Move as far as the body can go
+			this->x[index] += numberCast<Position>(displacement.x * time);
+			this->y[index] += numberCast<Position>(displacement.y * time);
+
+			if(!hit)
+				return;
+
+			// Bounce off whatever was hit
+			const Number speed = (normal.x != 0) ? absolute(velocity.x) : absolute(velocity.y);
+
+			if(normal.x != 0)
+				this->vx[index] = numberCast<Velocity>(-velocity.x * restitution);
+			else
+				this->vy[index] = numberCast<Velocity>(-velocity.y * restitution);
+
+			// The normal points towards the body, but events point away from it
+			this->report(ContactEvent(hitKind, ContactPhase::Hit, index, hitIndex, Vector2(-normal.x, -normal.y), (speed * (1 + restitution))));
+
+			remaining = (remaining * (1 - time));
+		}
+	}
+
+	// Finds when a body moving along an axis would pass the minimum or maximum,
+	// as a fraction of the displacement.
+	// Returns true if that's sooner than the specified time, replacing it.
+	static bool sweepEdge(Number position, Number displacement, int16_t minimum, int16_t maximum, Number & time)
+	{
+		Number distance;
+
+		if(displacement > 0)
+			distance = (maximum - position);
+		else if(displacement < 0)
+			distance = (position - minimum);
+		else
+			return false;
+
+		const Number speed = absolute(displacement);
+
+		if(distance >= speed)
+			return false;
+
+		// A body that has already strayed past the edge bounces straight away
+		const Number edgeTime = (distance > 0) ? (distance / speed) : Number(0);
+
+		if(edgeTime >= time)
+			return false;
+
+		time = edgeTime;
+		return true;
+	}
+
+	Rectangle getBox(uint8_t index) const
+	{
+		return Rectangle(this->getX(index), this->getY(index), this->sizes[index], this->sizes[index]);
+	}
+
+	// Circles are positioned by their centres
+	Circle getCircle(uint8_t index) const
+	{
+		const NumberU radius = (this->sizes[index] * NumberU(0.5));
+
+		return Circle(this->getX(index) + fromUnsigned(radius), this->getY(index) + fromUnsigned(radius), radius);
+	}
+
+	// Finds how two bodies overlap, if they do
+	bool collide(uint8_t first, uint8_t second, Manifold & manifold) const
+	{
+		// Most pairs that share a grid cell aren't touching,
+		// so test their bounding squares first, one axis at a time.
+		// Two boxes only need this test.
+		const uint8_t firstSize = this->sizes[first];
+		const uint8_t secondSize = this->sizes[second];
+
+		const Number halfSizes = ((firstSize + secondSize) * Number(0.5));
+		const Number centreOffset = ((secondSize - firstSize) * Number(0.5));
+
+		const Number offsetX = ((this->getX(second) - this->getX(first)) + centreOffset);
+		const Number overlapX = (halfSizes - absolute(offsetX));
+
+		if(overlapX <= 0)
+			return false;
+
+		const Number offsetY = ((this->getY(second) - this->getY(first)) + centreOffset);
+		const Number overlapY = (halfSizes - absolute(offsetY));
+
+		if(overlapY <= 0)
+			return false;
+
+		const bool firstCircle = ((this->flags[first] & BodyFlags::Circle) != 0);
+		const bool secondCircle = ((this->flags[second] & BodyFlags::Circle) != 0);
+
+		if(firstCircle)
+		{
+			if(secondCircle)
+				return ::collide(this->getCircle(first), this->getCircle(second), manifold);
+			else
+				return ::collide(this->getCircle(first), this->getBox(second), manifold);
+		}
+		else
+		{
+			if(secondCircle)
+				return ::collide(this->getBox(first), this->getCircle(second), manifold);
+		}
+
+		// Two boxes are pushed apart along the axis with the smallest overlap
+		if(overlapX < overlapY)
+			manifold = Manifold(Vector2((offsetX < 0) ? -1 : 1, 0), overlapX);
+		else
+			manifold = Manifold(Vector2(0, (offsetY < 0) ? -1 : 1), overlapY);
+
+		return true;
+	}
+
+	// Splits a correction between two bodies by their inverse masses
+	// Bodies of equal mass and static bodies are by far the most common,
+	// and their shares don't need a division
+	static void getShares(Number firstInverseMass, Number secondInverseMass, Number & firstShare, Number & secondShare)
+	{
+		if(firstInverseMass == secondInverseMass)
+		{
+			firstShare = Number(0.5);
+			secondShare = Number(0.5);
+		}
+		else if(firstInverseMass == 0)
+		{
+			firstShare = 0;
+			secondShare = 1;
+		}
+		else if(secondInverseMass == 0)
+		{
+			firstShare = 1;
+			secondShare = 0;
+		}
+		else
+		{
+			firstShare = (firstInverseMass / (firstInverseMass + secondInverseMass));
+			secondShare = (1 - firstShare);
+		}
+	}
+
+	// Moves two bodies so that their centres are the constraint's length apart
+	void solveConstraint(const DistanceConstraint & constraint, Number inverseTimeStep)
+	{
+		const uint8_t first = this->getIndex(constraint.first);
+		const uint8_t second = this->getIndex(constraint.second);
+
+		// Two static bodies can't be moved
+		if((this->inverseMass[first] == 0) && (this->inverseMass[second] == 0))
+			return;
+
+		// Positions are the top left, so allow for the difference in size
+		const Number sizeOffset = (Number(static_cast<int16_t>(this->sizes[second]) - static_cast<int16_t>(this->sizes[first])) * Number(0.5));
+		const Vector2 offset = Vector2((this->getX(second) - this->getX(first)) + sizeOffset, (this->getY(second) - this->getY(first)) + sizeOffset);
+
+		const auto distance = offset.getMagnitude();
+		const Number error = (fromUnsigned(distance) - constraint.length);
+
+		// Constraints that are only out by rounding are left alone,
+		// so that they don't keep constrained bodies awake
+		constexpr Number slack = (Number::Epsilon * 4);
+
+		if(absolute(error) <= slack)
+			return;
+
+		// Pulling on a sleeping body wakes it,
+		// but a distant body holds still, like a static one
+		this->wake(first, second);
+
+		Number firstShare;
+		Number secondShare;
+
+		if(!this->getAwakeShares(first, second, firstShare, secondShare))
+			return;
+
+		// A stretched constraint pulls the bodies together, and a squashed one pushes them apart
+		const Vector2 correction = (offset.getNormalised(distance) * error);
+
+		if(firstShare != 0)
+		{
+			Integrator::correct(this->x[first], this->vx[first], (correction.x * firstShare), inverseTimeStep);
+			Integrator::correct(this->y[first], this->vy[first], (correction.y * firstShare), inverseTimeStep);
+		}
+
+		if(secondShare != 0)
+		{
+			Integrator::correct(this->x[second], this->vx[second], -(correction.x * secondShare), inverseTimeStep);
+			Integrator::correct(this->y[second], this->vy[second], -(correction.y * secondShare), inverseTimeStep);
+		}
+	}
+
+	// Finds how a body overlaps a piece of static geometry, if it does.
+	// The normal points from the geometry towards the body.
+	bool collide(const StaticShape & shape, uint8_t index, Manifold & manifold) const
+	{
+		const bool bodyCircle = ((this->flags[index] & BodyFlags::Circle) != 0);
+
+		if(shape.shape == BodyShape::Circle)
+		{
+			if(bodyCircle)
+				return ::collide(shape.getCircle(), this->getCircle(index), manifold);
+			else
+				return ::collide(shape.getCircle(), this->getBox(index), manifold);
+		}
+		else
+		{
+			if(bodyCircle)
+				return ::collide(shape.getBox(), this->getCircle(index), manifold);
+			else
+				return ::collide(shape.getBox(), this->getBox(index), manifold);
+		}
+	}
+
+	// Pushes a body out of a piece of static geometry,
+	// and bounces it off if it's moving into it.
+	// The bounciness is one plus the coefficient of restitution.
+	void resolveStaticCollision(uint8_t index, uint8_t shape, const Manifold & manifold, Velocity bounciness)
+	{
+		++this->contactCount;
+
+		// The geometry can't move, so the body moves all the way out
+		this->x[index] += numberCast<Position>(manifold.normal.x * manifold.penetration);
+		this->y[index] += numberCast<Position>(manifold.normal.y * manifold.penetration);
+
+		const VelocityVector normal = VelocityVector(numberCast<Velocity>(manifold.normal.x), numberCast<Velocity>(manifold.normal.y));
+		const Velocity approachSpeed = -dotProduct(VelocityVector(this->vx[index], this->vy[index]), normal);
+
+		// If the body is already moving away, its velocity is left alone
+		if(approachSpeed <= 0)
+			return;
+
+		const Velocity impulse = (approachSpeed * bounciness);
+		const VelocityVector change = (normal * impulse);
+
+		this->vx[index] += change.x;
+		this->vy[index] += change.y;
+
+		// The normal points towards the body, but events point away from it
+		this->report(ContactEvent(ContactKind::Geometry, ContactPhase::Hit, index, shape, Vector2(-manifold.normal.x, -manifold.normal.y), numberCast<Number>(impulse)));
+	}
+
+	// Resolves a collision between two bodies, if they are colliding
+	void resolveCollision(uint8_t first, uint8_t second, Velocity bounciness)
+	{
+		Manifold manifold;
+
+		if(this->findContact(first, second, manifold))
+			this->resolveContact(first, second, manifold, bounciness);
+	}
+
+	// Resolves a contact between two bodies on its own.
+	// Overlapping bodies are pushed apart along the contact normal in proportion to their inverse masses,
+	// and exchange momentum along it if they are moving towards each other.
+	// The bounciness is one plus the coefficient of restitution.
+	//
+	// Being hit wakes a sleeping body, but a body that's still inactive, such as a distant one,
+	// is treated as static and isn't moved.
+	void resolveContact(uint8_t first, uint8_t second, const Manifold & manifold, Velocity bounciness)
+	{
+		// The speed at which the bodies are approaching each other along the normal
+		const VelocityVector normal = VelocityVector(numberCast<Velocity>(manifold.normal.x), numberCast<Velocity>(manifold.normal.y));
+		const Velocity approachSpeed = this->getApproachSpeed(first, second, normal);
+
+		if(approachSpeed > 0)
+			this->wake(first, second);
+
+		Number firstShare;
+		Number secondShare;
+
+		if(!this->getAwakeShares(first, second, firstShare, secondShare))
+			return;
+
+		this->separate(first, second, manifold, firstShare, secondShare);
+
+		// If the bodies are already separating, their velocities are left alone
+		if(approachSpeed <= 0)
+			return;
+
+		const Velocity impulse = (approachSpeed * bounciness);
+
+		this->changeVelocities(first, second, normal, impulse, firstShare, secondShare);
+		this->report(ContactEvent(ContactKind::Body, ContactPhase::Hit, first, second, manifold.normal, numberCast<Number>(impulse)));
+	}
+
+	// Resolves a collision between two bodies like resolveCollision,
+	// but only finds the contact and remembers it in the cache,
+	// then applies the impulse the contact needed on the last step.
+	// The rest of the impulse is found by solveContact.
+	//
+	// Rather than being moved out of each other, the bodies are given a speed to separate at,
+	// which closes a fraction of the overlap on each step.
+	// Moving them directly would undo the impulses holding up a stack,
+	// which is what makes warm starting worthwhile.
+	template< typename Cache >
+	void resolveCachedCollision(Cache & cache, uint8_t first, uint8_t second, Velocity restitution, Velocity threshold)
+	{
+		Manifold manifold;
+
+		if(!this->findContact(first, second, manifold))
+			return;
+
+		const VelocityVector normal = VelocityVector(numberCast<Velocity>(manifold.normal.x), numberCast<Velocity>(manifold.normal.y));
+		const Velocity approachSpeed = this->getApproachSpeed(first, second, normal);
+
+		auto * contact = cache.touch(first, second);
+
+		// If there's no room to remember the contact, resolve it on its own
+		if(contact == nullptr)
+		{
+			this->resolveContact(first, second, manifold, (1 + restitution));
+			return;
+		}
+
+		using Impulse = typename Cache::Impulse;
+
+		// Overlaps smaller than the slop are left alone, so that resting contacts are still found on the next step.
+		// A quarter of the rest of the overlap is closed on each step.
+		constexpr Number slop = 0.5;
+
+		// Overlaps deeper than a pixel, as when bodies land on each other, are moved out of straight away,
+		// so that a body can never be pushed far enough through another to come out of the other side.
+		constexpr Number deepest = 1;
+
+		// A contact that wasn't already pushing the bodies apart is a new impact, so it bounces.
+		// Bodies resting on each other are pushed apart every step, so they don't.
+		const bool isImpact = ((contact->impulse == 0) && (approachSpeed > threshold));
+
+		// Only an impact wakes a sleeping body
+		if(isImpact)
+			this->wake(first, second);
+
+		if(manifold.penetration > deepest)
+		{
+			Manifold excess = manifold;
+			excess.penetration = (manifold.penetration - deepest);
+
+			Number firstShare;
+			Number secondShare;
+
+			// The body at the bottom of a pile is pushed into the floor and back out again on every step,
+			// so a sleeping body isn't moved, or the pile would never stay asleep
+			if(this->getAwakeShares(first, second, firstShare, secondShare))
+				this->separate(first, second, excess, firstShare, secondShare);
+
+			manifold.penetration = deepest;
+		}
+
+		const Number depth = (manifold.penetration > slop) ? (manifold.penetration - slop) : Number(0);
+
+		const Velocity bounce = isImpact ? (approachSpeed * restitution) : Velocity(0);
+		const Velocity correction = numberCast<Velocity>(depth / 4);
+
+		// A bounce separates the bodies anyway, so the two aren't added together
+		contact->normal = manifold.normal;
+		contact->bias = numberCast<Impulse>((bounce > correction) ? bounce : correction);
+
+		// Warm start the contact
+		if(contact->impulse != 0)
+			this->applyImpulse(first, second, normal, numberCast<Velocity>(contact->impulse));
+	}
+
+	// Pushes the bodies of a cached contact apart just enough that they stop approaching each other,
+	// or separate at the speed they should bounce at.
+	// The contact's total impulse is never allowed to pull the bodies together.
+	template< typename Contact >
+	void solveContact(Contact & contact)
+	{
+		using Impulse = typename Contact::Impulse;
+
+		const uint8_t first = contact.first;
+		const uint8_t second = contact.second;
+
+		const VelocityVector normal = VelocityVector(numberCast<Velocity>(contact.normal.x), numberCast<Velocity>(contact.normal.y));
+		const Impulse approachSpeed = numberCast<Impulse>(this->getApproachSpeed(first, second, normal));
+
+		// Clamp the total, rather than each change, so a later iteration can take back
+		// some of what an earlier one applied
+		const Impulse previous = contact.impulse;
+		const Impulse total = (previous + approachSpeed + contact.bias);
+
+		contact.impulse = (total > 0) ? total : Impulse(0);
+
+		const Impulse change = (contact.impulse - previous);
+
+		if(change != 0)
+			this->applyImpulse(first, second, normal, numberCast<Velocity>(change));
+	}
+
+	// The inverse mass of a body as far as a cached contact is concerned.
+	// A sleeping body holds still, like a static one,
+	// so that a pile can fall asleep while its contacts are still remembered.
+	Number getAwakeInverseMass(uint8_t index) const
+	{
+		return ((this->flags[index] & BodyFlags::Inactive) != 0) ? Number(0) : this->inverseMass[index];
+	}
+
+	// Splits a correction between two bodies by their awake inverse masses.
+	// Returns false if neither body can be moved.
+	bool getAwakeShares(uint8_t first, uint8_t second, Number & firstShare, Number & secondShare) const
+	{
+		const Number firstInverseMass = this->getAwakeInverseMass(first);
+		const Number secondInverseMass = this->getAwakeInverseMass(second);
+
+		if((firstInverseMass == 0) && (secondInverseMass == 0))
+			return false;
+
+		getShares(firstInverseMass, secondInverseMass, firstShare, secondShare);
+
+		return true;
+	}
+
+	// Changes the velocities of two bodies by equal and opposite impulses along the normal,
+	// without moving bodies that are asleep
+	void applyImpulse(uint8_t first, uint8_t second, const VelocityVector & normal, Velocity impulse)
+	{
+		Number firstShare;
+		Number secondShare;
+
+		if(this->getAwakeShares(first, second, firstShare, secondShare))
+			this->changeVelocities(first, second, normal, impulse, firstShare, secondShare);
+	}
+
+	// Finds how two bodies overlap, if they do, counting the contact.
+	// Returns false if the bodies aren't colliding, or are both static.
+	bool findContact(uint8_t first, uint8_t second, Manifold & manifold)
+	{
+		// Static bodies never collide with each other
+		if((this->inverseMass[first] == 0) && (this->inverseMass[second] == 0))
+			return false;
+
+		if(!this->collide(first, second, manifold))
+			return false;
+
+		++this->contactCount;
+
+		return true;
+	}
+
+	// Pushes two bodies out of each other along the contact normal, in proportion to their inverse masses
+	void separate(uint8_t first, uint8_t second, const Manifold & manifold, Number firstShare, Number secondShare)
+	{
+		const Vector2 correction = (manifold.normal * manifold.penetration);
+
+		this->x[first] -= numberCast<Position>(correction.x * firstShare);
+		this->y[first] -= numberCast<Position>(correction.y * firstShare);
+		this->x[second] += numberCast<Position>(correction.x * secondShare);
+		this->y[second] += numberCast<Position>(correction.y * secondShare);
+	}
+
+	// The speed at which two bodies are approaching each other along the normal,
+	// which is negative if they're separating
+	Velocity getApproachSpeed(uint8_t first, uint8_t second, const VelocityVector & normal) const
+	{
+		const VelocityVector relativeVelocity = VelocityVector(this->vx[second] - this->vx[first], this->vy[second] - this->vy[first]);
+
+		return -dotProduct(relativeVelocity, normal);
+	}
+
+	// Wakes two bodies that have hit or pulled on each other.
+	// Static bodies are never woken, so they stay out of every pass.
+	void wake(uint8_t first, uint8_t second)
+	{
+		if(this->inverseMass[first] != 0)
+			this->wake(first);
+
+		if(this->inverseMass[second] != 0)
+			this->wake(second);
+	}
+
+	void changeVelocities(uint8_t first, uint8_t second, const VelocityVector & normal, Velocity impulse, Number firstShare, Number secondShare)
+	{
+		// This is getImpulse multiplied through by each body's inverse mass
+		const VelocityVector change = (normal * impulse);
+		const Velocity firstVelocityShare = numberCast<Velocity>(firstShare);
+		const Velocity secondVelocityShare = numberCast<Velocity>(secondShare);
+
+		this->vx[first] -= (change.x * firstVelocityShare);
+		this->vy[first] -= (change.y * firstVelocityShare);
+		this->vx[second] += (change.x * secondVelocityShare);
+		this->vy[second] += (change.y * secondVelocityShare);
+	}
+};
\ No newline at end of file
@@ -19,43 +19,52 @@
 #include "Common.h"
 #include "Vector.h"
 
-class Point2
+template< typename T >
+class BasicVector2;
+
+template< typename T >
+class BasicPoint2
 {
+public:
+	// Types
+	using Scalar = T;
+	using Vector = BasicVector2<T>;
+
 public:
 	// Fields
-	Number x;
-	Number y;
+	T x;
+	T y;
 
 public:
 	// Constructors
-	constexpr Point2() = default;
+	constexpr BasicPoint2() = default;
 
-	constexpr Point2(int8_t x, int8_t y) :
+	constexpr BasicPoint2(int8_t x, int8_t y) :
 		x { x },
 		y { y }
 	{
 	}
 
-	constexpr Point2(int16_t x, int16_t y) :
+	constexpr BasicPoint2(int x, int y) :
 		x { x },
 		y { y }
 	{
 	}
 
-	constexpr Point2(Number x, Number y) :
+	constexpr BasicPoint2(T x, T y) :
 		x { x },
 		y { y }
 	{
 	}
 
-	Point2 & operator +=(Vector2 other)
+	BasicPoint2 & operator +=(Vector other)
 	{
 		this->x += other.x;
 		this->y += other.y;
 		return *this;
 	}
 
-	Point2 & operator -=(Vector2 other)
+	BasicPoint2 & operator -=(Vector other)
 	{
 		this->x -= other.x;
 		this->y -= other.y;
@@ -63,18 +72,23 @@ public:
 	}
 };
 
-inline constexpr bool operator ==(Point2 left, Point2 right)
+using Point2 = BasicPoint2<Number>;
+
+template< typename T >
+inline constexpr bool operator ==(BasicPoint2<T> left, BasicPoint2<T> right)
 {
 	return ((left.x == right.x) && (left.y == right.y));
 }
 
-inline constexpr bool operator !=(Point2 left, Point2 right)
+template< typename T >
+inline constexpr bool operator !=(BasicPoint2<T> left, BasicPoint2<T> right)
 {
 	return ((left.x != right.x) || (left.y != right.y));
 }
 
 // Shorthand to get square distance between two points
-inline constexpr NumberU distanceSquared(Point2 firstPoint, Point2 secondPoint)
+template< typename T >
+inline constexpr UnsignedType<T> distanceSquared(BasicPoint2<T> firstPoint, BasicPoint2<T> secondPoint)
 {
 	// Constexpr version:
 	return fromSigned(square(firstPoint.x - secondPoint.x) + square(firstPoint.y - secondPoint.y));
@@ -85,19 +99,22 @@ inline constexpr NumberU distanceSquared(Point2 firstPoint, Point2 secondPoint)
 //
 
 // Adding a vector to a point offsets the point
-inline constexpr Point2 operator +(Point2 point, Vector2 offset)
+template< typename T >
+inline constexpr BasicPoint2<T> operator +(BasicPoint2<T> point, BasicVector2<T> offset)
 {
-	return Point2((point.x + offset.x), (point.y + offset.y));
+	return BasicPoint2<T>((point.x + offset.x), (point.y + offset.y));
 }
 
 // Subtracting a vector from a point offsets the point
-inline constexpr Point2 operator -(Point2 point, Vector2 offset)
+template< typename T >
+inline constexpr BasicPoint2<T> operator -(BasicPoint2<T> point, BasicVector2<T> offset)
 {
-	return Point2((point.x - offset.x), (point.y - offset.y));
+	return BasicPoint2<T>((point.x - offset.x), (point.y - offset.y));
 }
 
 // Subtracting two points gets the vector between them
-inline constexpr Vector2 operator -(Point2 firstPoint, Point2 secondPoint)
+template< typename T >
+inline constexpr BasicVector2<T> operator -(BasicPoint2<T> firstPoint, BasicPoint2<T> secondPoint)
 {
-	return Vector2((firstPoint.x - secondPoint.x), (firstPoint.y - secondPoint.y));
+	return BasicVector2<T>((firstPoint.x - secondPoint.x), (firstPoint.y - secondPoint.y));
 }
\ No newline at end of file
@@ -0,0 +1,98 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+#include "ConstantFactor.h"
+
+// Chooses the number types a physics world stores each quantity in
+//
+// Positions need the range to cover the screen,
+// velocities are small but benefit from more fractional bits,
+// and coefficients are fractions between zero and one
+template< typename PositionType, typename VelocityType, typename CoefficientType >
+struct PrecisionTraits
+{
+	using Position = PositionType;
+	using Velocity = VelocityType;
+	using Coefficient = CoefficientType;
+};
+
+// Every quantity is a Number
+using DefaultPrecision = PrecisionTraits<Number, Number, Number>;
+
+// Velocities have three more fractional bits, but can't exceed 16 pixels per step,
+// and coefficients are a single byte, so scaling a velocity needs no 32 bit multiplication
+using FinePrecision = PrecisionTraits<Number, SFixed<4, 11>, UFixed<0, 8>>;
+
+// Scales a value by a coefficient
+template< typename Value, typename Coefficient >
+struct CoefficientScale
+{
+	static Value scale(Value value, Coefficient coefficient)
+	{
+		return (value * numberCast<Value>(coefficient));
+	}
+};
+
+template< typename Value >
+struct CoefficientScale<Value, Value>
+{
+	static Value scale(Value value, Value coefficient)
+	{
+		return (value * coefficient);
+	}
+};
+
+// A 16 bit value is split into its high and low bytes,
+// so the product needs two 8 bit multiplications rather than a 32 bit one
+template< unsigned Integer, unsigned Fraction >
+struct CoefficientScale<SFixed<Integer, Fraction>, UFixed<0, 8>>
+{
+	static_assert((Integer + Fraction) == 15, "The value must be 16 bits");
+
+	static SFixed<Integer, Fraction> scale(SFixed<Integer, Fraction> value, UFixed<0, 8> coefficient)
+	{
+		const int16_t internal = value.getInternal();
+		const uint8_t factor = coefficient.getInternal();
+
+		// (high * 256 + low) * factor / 256 == high * factor + (low * factor / 256)
+		const int8_t high = static_cast<int8_t>(internal >> 8);
+		const uint8_t low = static_cast<uint8_t>(internal);
+
+		const int16_t highProduct = (static_cast<int16_t>(high) * factor);
+		const uint16_t lowProduct = (static_cast<uint16_t>(low) * factor);
+
+		return SFixed<Integer, Fraction>::fromInternal(static_cast<int16_t>(highProduct + (lowProduct >> 8)));
+	}
+};
+
+// A constant factor needs no multiplication at all
+template< typename Value, uint8_t numerator >
+struct CoefficientScale<Value, ConstantFactor<numerator>>
+{
+	static Value scale(Value value, ConstantFactor<numerator>)
+	{
+		return ConstantFactor<numerator>::scale(value);
+	}
+};
+
+template< typename Value, typename Coefficient >
+inline Value scaleByCoefficient(Value value, Coefficient coefficient)
+{
+	return CoefficientScale<Value, Coefficient>::scale(value, coefficient);
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// A small random number generator (Marsaglia's xorshift32)
+//
+// Each number takes three shifts and three exclusive ors of a 32 bit state,
+// and ranges are reduced by multiplying and keeping the high bits rather than by division,
+// so it's much cheaper than Arduino's random(), which divides twice per call.
+// Unlike random(), each generator has its own state,
+// so a scene or a benchmark can seed its own and get the same numbers every time.
+class Random
+{
+public:
+	// Used when the state would otherwise be zero, which xorshift can never leave
+	static constexpr uint32_t defaultSeed = 2463534242UL;
+
+private:
+	// Fields
+	uint32_t state;
+
+private:
+	static constexpr uint32_t makeState(uint32_t seed)
+	{
+		return (seed != 0) ? seed : defaultSeed;
+	}
+
+public:
+	// Constructors
+	constexpr Random() :
+		state { defaultSeed }
+	{
+	}
+
+	constexpr explicit Random(uint32_t seed) :
+		state { makeState(seed) }
+	{
+	}
+
+	void seed(uint32_t seed)
+	{
+		this->state = makeState(seed);
+	}
+
+	uint32_t next()
+	{
+		uint32_t value = this->state;
+
+		value ^= (value << 13);
+		value ^= (value >> 17);
+		value ^= (value << 5);
+
+		this->state = value;
+
+		return value;
+	}
+
+	// The high bits of xorshift are the most random, so smaller numbers are taken from the top
+	uint16_t next16()
+	{
+		return static_cast<uint16_t>(this->next() >> 16);
+	}
+
+	// Returns a number from zero up to but not including the limit
+	uint16_t nextBelow(uint16_t limit)
+	{
+		return static_cast<uint16_t>((static_cast<uint32_t>(this->next16()) * limit) >> 16);
+	}
+
+	// Returns a number from the minimum up to but not including the maximum,
+	// or the minimum if the range is empty
+	int16_t nextBetween(int16_t minimum, int16_t maximum)
+	{
+		return (maximum > minimum) ? static_cast<int16_t>(minimum + this->nextBelow(static_cast<uint16_t>(maximum - minimum))) : minimum;
+	}
+
+	// Returns a fixed point number from the minimum up to but not including the maximum,
+	// with a random integer part and a random fraction,
+	// as if it were made by Fixed(nextBetween(minimum, maximum), nextBelow(1 << Fixed::FractionSize)),
+	// but with a single number drawn for both
+	template< typename Fixed >
+	Fixed nextFixed(int8_t minimum, int8_t maximum)
+	{
+		using Internal = typename Fixed::InternalType;
+
+		constexpr uint8_t fractionSize = Fixed::FractionSize;
+
+		// The number of representable values between the two
+		const uint32_t range = (maximum > minimum) ? (static_cast<uint32_t>(maximum - minimum) << fractionSize) : 0;
+
+		const uint32_t offset = ((static_cast<uint32_t>(this->next16()) * range) >> 16);
+
+		return Fixed::fromInternal(static_cast<Internal>((static_cast<int32_t>(minimum) * (static_cast<int32_t>(1) << fractionSize)) + static_cast<int32_t>(offset)));
+	}
+
+	// Fills an array with fixed point numbers, as nextFixed does
+	template< typename Fixed, uint8_t size >
+	void fill(Fixed (&values)[size], int8_t minimum, int8_t maximum)
+	{
+		for(uint8_t index = 0; index < size; ++index)
+			values[index] = this->nextFixed<Fixed>(minimum, maximum);
+	}
+};
\ No newline at end of file
@@ -20,100 +20,107 @@
 #include "Point.h"
 #include "Size.h"
 
-class Rectangle
+template< typename T >
+class BasicRectangle
 {
+public:
+	// Types
+	using Scalar = T;
+	using Point = BasicPoint2<T>;
+	using Size = BasicSize2<UnsignedType<T>>;
+
 public:
 	// Fields
-	Point2 position;
-	Size2 size;
+	Point position;
+	Size size;
 
 public:
 	// Constructors
-	constexpr Rectangle() = default;
+	constexpr BasicRectangle() = default;
 
-	constexpr Rectangle(Point2 position) :
+	constexpr BasicRectangle(Point position) :
 		position { position },
 		size { 1, 1 }
 	{
 	}
 
-	constexpr Rectangle(Point2 position, Size2 size) :
+	constexpr BasicRectangle(Point position, Size size) :
 		position { position },
 		size { size }
 	{
 	}
 
-	constexpr Rectangle(Point2 position, uint8_t width, uint8_t height) :
+	constexpr BasicRectangle(Point position, uint8_t width, uint8_t height) :
 		position { position },
 		size { width, height }
 	{
 	}
 
-	constexpr Rectangle(Number x, Number y) :
+	constexpr BasicRectangle(T x, T y) :
 		position { x, y },
 		size { 1, 1 }
 	{
 	}
 
-	constexpr Rectangle(Number x, Number y, Size2 size) :
+	constexpr BasicRectangle(T x, T y, Size size) :
 		position { x, y },
 		size { size }
 	{
 	}
 
-	constexpr Rectangle(Number x, Number y, uint8_t width, uint8_t height) :
+	constexpr BasicRectangle(T x, T y, uint8_t width, uint8_t height) :
 		position { x, y },
 		size { width, height }
 	{
 	}
 
-	constexpr Number getX() const
+	constexpr T getX() const
 	{
 		return this->position.x;
 	}
 
-	constexpr Number getY() const
+	constexpr T getY() const
 	{
 		return this->position.y;
 	}
 
-	constexpr Size2 getSize() const
+	constexpr Size getSize() const
 	{
 		return this->size;
 	}
 
-	constexpr NumberU getWidth() const
+	constexpr UnsignedType<T> getWidth() const
 	{
 		return this->size.width;
 	}
 
-	constexpr NumberU getHeight() const
+	constexpr UnsignedType<T> getHeight() const
 	{
 		return this->size.height;
 	}
 
-	constexpr Number getLeft() const
+	constexpr T getLeft() const
 	{
 		return this->getX();
 	}
 
-	constexpr Number getRight() const
+	constexpr T getRight() const
 	{
 		return (this->getX() + fromUnsigned(this->getWidth()));
 	}
 
-	constexpr Number getTop() const
+	constexpr T getTop() const
 	{
 		return this->getY();
 	}
 
-	constexpr Number getBottom() const
+	constexpr T getBottom() const
 	{
 		return (this->getY() + fromUnsigned(this->getHeight()));
 	}
 
 	// Returns true if the point intersects the rectangle
-	constexpr bool intersects(Point2 point) const
+	constexpr bool intersects(Point point) const
 	{
 		return
 			(point.x >= this->getLeft()) &&
@@ -123,8 +130,11 @@ public:
 	}
 };
 
+using Rectangle = BasicRectangle<Number>;
+
 // Returns true if the rectangles intersect each other
-constexpr inline bool intersects(Rectangle first, Rectangle second)
+template< typename T >
+constexpr inline bool intersects(BasicRectangle<T> first, BasicRectangle<T> second)
 {
 	return
 	!(
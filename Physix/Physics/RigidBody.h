@@ -20,44 +20,91 @@
 #include "Point.h"
 #include "Vector.h"
 
-class RigidBody
+template< typename T >
+class BasicRigidBody
 {
+public:
+	// Types
+	using Scalar = T;
+	using Point = BasicPoint2<T>;
+	using Vector = BasicVector2<T>;
+
 public:
 	// Fields
-	Point2 position = Point2(0, 0);
-	Vector2 velocity = Vector2(0, 0);
-	Number mass = 1.0;
+	Point position = Point(0, 0);
+	Vector velocity = Vector(0, 0);
+
+private:
+	// The inverse mass is kept alongside the mass so that
+	// applying a force is a multiplication rather than a division.
+	// A static body has an inverse mass of zero.
+	T mass = 1.0;
+	T inverseMass = 1.0;
 
 public:
 	// Constructors
-	constexpr RigidBody() = default;
+	constexpr BasicRigidBody() = default;
 
-	constexpr RigidBody(Point2 position) :
+	constexpr BasicRigidBody(Point position) :
 		position { position },
 		velocity {  },
-		mass { 1.0 }
+		mass { 1.0 },
+		inverseMass { 1.0 }
 	{
 	}
 
-	constexpr RigidBody(Point2 position, Number mass) :
+	constexpr BasicRigidBody(Point position, T mass) :
 		position { position },
 		velocity {  },
-		mass { mass }
+		mass { mass },
+		inverseMass { 1 / mass }
 	{
 	}
 
-	constexpr Number getX() const
+	constexpr T getX() const
 	{
 		return this->position.x;
 	}
 
-	constexpr Number getY() const
+	constexpr T getY() const
 	{
 		return this->position.y;
 	}
 
-	void applyForce(Vector2 force)
+	constexpr T getMass() const
+	{
+		return this->mass;
+	}
+
+	constexpr T getInverseMass() const
 	{
-		this->velocity += (force / mass);
+		return this->inverseMass;
 	}
-};
\ No newline at end of file
+
+	void setMass(T mass)
+	{
+		this->mass = mass;
+		this->inverseMass = (1 / mass);
+	}
+
+	// Returns true if the body is immovable
+	constexpr bool isStatic() const
+	{
+		return (this->inverseMass == 0);
+	}
+
+	// Makes the body immovable.
+	// Static bodies ignore forces and are never integrated.
+	void makeStatic()
+	{
+		this->velocity = Vector(0, 0);
+		this->inverseMass = 0;
+	}
+
+	void applyForce(Vector force)
+	{
+		this->velocity += (force * this->inverseMass);
+	}
+};
+
+using RigidBody = BasicRigidBody<Number>;
\ No newline at end of file
@@ -18,30 +18,39 @@
 
 #include "Common.h"
 
-class Size2
+template< typename T >
+class BasicSize2
 {
+public:
+	// Types
+	using Scalar = T;
+
 public:
 	// Fields
-	NumberU width;
-	NumberU height;
+	T width;
+	T height;
 
 public:
 	// Constructors
-	constexpr Size2() = default;
+	constexpr BasicSize2() = default;
 
-	constexpr Size2(NumberU width, NumberU height) :
+	constexpr BasicSize2(T width, T height) :
 		width { width },
 		height { height }
 	{
 	}
 };
 
-inline constexpr bool operator ==(Size2 left, Size2 right)
+using Size2 = BasicSize2<NumberU>;
+
+template< typename T >
+inline constexpr bool operator ==(BasicSize2<T> left, BasicSize2<T> right)
 {
 	return ((left.width == right.width) && (left.height == right.height));
 }
 
-inline constexpr bool operator !=(Size2 left, Size2 right)
+template< typename T >
+inline constexpr bool operator !=(BasicSize2<T> left, BasicSize2<T> right)
 {
 	return ((left.width != right.width) || (left.height != right.height));
 }
\ No newline at end of file
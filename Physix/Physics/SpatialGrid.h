@@ -0,0 +1,119 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include "Common.h"
+
+// A uniform grid used as a broad phase for collision detection.
+//
+// Rather than storing a list per cell, the grid stores one bit mask
+// per column and one bit mask per row, with one bit per body.
+// Because a body's bounds are rectangular, a body occupies a cell
+// exactly when it occupies both the cell's column and the cell's row,
+// so the occupants of a group of cells can be found with a few ORs and one AND.
+template< uint8_t capacityValue, uint8_t columnsValue = 16, uint8_t rowsValue = 8, uint8_t cellShiftValue = 3 >
+class SpatialGrid
+{
+public:
+	// Constants
+	static constexpr uint8_t capacity = capacityValue;
+	static constexpr uint8_t columns = columnsValue;
+	static constexpr uint8_t rows = rowsValue;
+	static constexpr uint8_t cellShift = cellShiftValue;
+	static constexpr uint8_t cellSize = (1 << cellShift);
+
+	using Mask = typename BitMask<capacity>::Type;
+
+private:
+	// Fields
+	Mask columnMasks[columns];
+	Mask rowMasks[rows];
+
+private:
+	static constexpr uint8_t clampColumn(int16_t column)
+	{
+		return (column < 0) ? 0 : (column >= columns) ? (columns - 1) : static_cast<uint8_t>(column);
+	}
+
+	static constexpr uint8_t clampRow(int16_t row)
+	{
+		return (row < 0) ? 0 : (row >= rows) ? (rows - 1) : static_cast<uint8_t>(row);
+	}
+
+public:
+	// Returns a mask with only the bit for the specified body set
+	static constexpr Mask getMask(uint8_t index)
+	{
+		return static_cast<Mask>(static_cast<Mask>(1) << index);
+	}
+
+	// Returns a mask with the bits set for every body after the specified body
+	static constexpr Mask getMaskAfter(uint8_t index)
+	{
+		return static_cast<Mask>(~((getMask(index) << 1) - 1));
+	}
+
+	// Removes all bodies from the grid
+	void clear()
+	{
+		for(Mask & mask : this->columnMasks)
+			mask = 0;
+
+		for(Mask & mask : this->rowMasks)
+			mask = 0;
+	}
+
+	// Adds a body covering the specified pixels to the grid
+	void insert(uint8_t index, int16_t x, int16_t y, uint8_t width, uint8_t height)
+	{
+		const Mask mask = getMask(index);
+
+		const uint8_t left = clampColumn(x >> cellShift);
+		const uint8_t right = clampColumn((x + width - 1) >> cellShift);
+
+		for(uint8_t column = left; column <= right; ++column)
+			this->columnMasks[column] |= mask;
+
+		const uint8_t top = clampRow(y >> cellShift);
+		const uint8_t bottom = clampRow((y + height - 1) >> cellShift);
+
+		for(uint8_t row = top; row <= bottom; ++row)
+			this->rowMasks[row] |= mask;
+	}
+
+	// Returns the bodies sharing at least one cell with the specified pixels
+	Mask getOccupants(int16_t x, int16_t y, uint8_t width, uint8_t height) const
+	{
+		Mask columnMask = 0;
+
+		const uint8_t left = clampColumn(x >> cellShift);
+		const uint8_t right = clampColumn((x + width - 1) >> cellShift);
+
+		for(uint8_t column = left; column <= right; ++column)
+			columnMask |= this->columnMasks[column];
+
+		Mask rowMask = 0;
+
+		const uint8_t top = clampRow(y >> cellShift);
+		const uint8_t bottom = clampRow((y + height - 1) >> cellShift);
+
+		for(uint8_t row = top; row <= bottom; ++row)
+			rowMask |= this->rowMasks[row];
+
+		return (columnMask & rowMask);
+	}
+};
\ No newline at end of file
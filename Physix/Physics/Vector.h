@@ -17,73 +17,152 @@
 #pragma once
 
 #include "Common.h"
+#include "ConstantFactor.h"
 #include "Point.h"
 
-class Vector2
+template< typename T >
+class BasicVector2
 {
+public:
+	// Types
+	using Scalar = T;
+	using Magnitude = UnsignedType<T>;
+
+	// The raw calculations square the internal values in 32 bits
+	// and normalise with a reciprocal with 16 more fractional bits
+	static_assert(sizeof(typename T::InternalType) <= 2, "Vectors only support fixed point types of up to 16 bits");
+	static_assert(T::FractionSize <= 14, "Vectors only support up to 14 fractional bits");
+
 public:
 	// Fields
-	Number x;
-	Number y;
+	T x;
+	T y;
 
 public:
 	// Constructors
-	constexpr Vector2() = default;
+	constexpr BasicVector2() = default;
 
-	constexpr Vector2(int8_t x, int8_t y) :
+	constexpr BasicVector2(int8_t x, int8_t y) :
 		x { x },
 		y { y }
 	{
 	}
 
-	constexpr Vector2(int16_t x, int16_t y) :
+	constexpr BasicVector2(int x, int y) :
 		x { x },
 		y { y }
 	{
 	}
 
-	constexpr Vector2(Number x, Number y) :
+	constexpr BasicVector2(T x, T y) :
 		x { x },
 		y { y }
 	{
 	}
 
-	// Can't do a regular get magnitude without using float because
-	// I don't have a fixed point sqrt
-	constexpr NumberU getMagnitudeSquared() const
+	// Note: overflows for vectors longer than 16
+	constexpr Magnitude getMagnitudeSquared() const
 	{
 		return fromSigned((x * x) + (y * y));
 	}
 
-	Vector2 & operator +=(Vector2 other)
+	// Squares the raw values instead, so it works for any vector
+	Magnitude getMagnitude() const
+	{
+		const uint32_t x = absolute(static_cast<int32_t>(this->x.getInternal()));
+		const uint32_t y = absolute(static_cast<int32_t>(this->y.getInternal()));
+
+		// sqrt(x * x + y * y) scales the same way as x and y do
+		return Magnitude::fromInternal(squareRoot((x * x) + (y * y)));
+	}
+
+	// Approximates the magnitude as (15/16 * max) + (15/32 * min)
+	// Within 6.25% (plus rounding), using only shifts and additions
+	Magnitude getApproximateMagnitude() const
+	{
+		const uint16_t x = static_cast<uint16_t>(absolute(static_cast<int32_t>(this->x.getInternal())));
+		const uint16_t y = static_cast<uint16_t>(absolute(static_cast<int32_t>(this->y.getInternal())));
+
+		const uint16_t maximum = (x > y) ? x : y;
+		const uint16_t minimum = (x > y) ? y : x;
+
+		return Magnitude::fromInternal((maximum - (maximum >> 4)) + ((minimum >> 1) - (minimum >> 5)));
+	}
+
+	// Returns a vector of length 1 in the same direction
+	// A zero vector stays as it is
+	BasicVector2 getNormalised() const
+	{
+		return this->getNormalised(this->getMagnitude());
+	}
+
+	// As getNormalised, but using getApproximateMagnitude
+	// The result is within about 7% of length 1
+	BasicVector2 getApproximateNormalised() const
+	{
+		return this->getNormalised(this->getApproximateMagnitude());
+	}
+
+	// As getNormalised, for when the magnitude is already known
+	// Divides using a single reciprocal with 16 fractional bits,
+	// so short vectors don't lose precision
+	BasicVector2 getNormalised(Magnitude magnitude) const
+	{
+		if(magnitude.getInternal() == 0)
+			return *this;
+
+		const int32_t reciprocal = static_cast<int32_t>((static_cast<uint32_t>(1) << (16 + T::FractionSize)) / magnitude.getInternal());
+
+		const int32_t x = ((static_cast<int32_t>(this->x.getInternal()) * reciprocal) >> 16);
+		const int32_t y = ((static_cast<int32_t>(this->y.getInternal()) * reciprocal) >> 16);
+
+		return BasicVector2(T::fromInternal(static_cast<typename T::InternalType>(x)), T::fromInternal(static_cast<typename T::InternalType>(y)));
+	}
+
+	BasicVector2 & normalise()
+	{
+		*this = this->getNormalised();
+		return *this;
+	}
+
+	BasicVector2 & operator +=(BasicVector2 other)
 	{
 		this->x += other.x;
 		this->y += other.y;
 		return *this;
 	}
 
-	Vector2 & operator -=(Vector2 other)
+	BasicVector2 & operator -=(BasicVector2 other)
 	{
 		this->x -= other.x;
 		this->y -= other.y;
 		return *this;
 	}
 
-	Vector2 & operator *=(Number factor)
+	BasicVector2 & operator *=(T factor)
 	{
 		this->x *= factor;
 		this->y *= factor;
 		return *this;
 	}
 
-	/*Vector2 & operator *=(NumberU factor)
+	// Scales with shifts and additions rather than multiplication
+	template< uint8_t numerator >
+	BasicVector2 & operator *=(ConstantFactor<numerator> factor)
+	{
+		this->x = factor.scale(this->x);
+		this->y = factor.scale(this->y);
+		return *this;
+	}
+
+	/*BasicVector2 & operator *=(Magnitude factor)
 	{
 		this->x *= fromUnsigned(factor);
 		this->y *= fromUnsigned(factor);
 		return *this;
 	}*/
 
-	Vector2 & operator /=(Number factor)
+	BasicVector2 & operator /=(T factor)
 	{
 		const auto inverseFactor = (1 / factor);
 
@@ -92,7 +171,7 @@ public:
 		return *this;
 	}
 
-	/*Vector2 & operator /=(NumberU factor)
+	/*BasicVector2 & operator /=(Magnitude factor)
 	{
 		const auto inverseFactor = fromUnsigned(1 / factor);
 		this->x *= inverseFactor;
@@ -100,7 +179,7 @@ public:
 		return *this;
 	}*/
 
-	Vector2 & operator -()
+	BasicVector2 & operator -()
 	{
 		this->x = -this->x;
 		this->y = -this->y;
@@ -108,36 +187,52 @@ public:
 	}
 };
 
-inline constexpr bool operator ==(Vector2 left, Vector2 right)
+using Vector2 = BasicVector2<Number>;
+
+template< typename T >
+inline constexpr bool operator ==(BasicVector2<T> left, BasicVector2<T> right)
 {
 	return ((left.x == right.x) && (left.y == right.y));
 }
 
-inline constexpr bool operator !=(Vector2 left, Vector2 right)
+template< typename T >
+inline constexpr bool operator !=(BasicVector2<T> left, BasicVector2<T> right)
 {
 	return ((left.x != right.x) || (left.y != right.y));
 }
 
 // Adding a vector to a vector creates a new vector
-inline constexpr Vector2 operator +(Vector2 left, Vector2 right)
+template< typename T >
+inline constexpr BasicVector2<T> operator +(BasicVector2<T> left, BasicVector2<T> right)
 {
-	return Vector2(left.x + right.x, left.y + right.y);
+	return BasicVector2<T>(left.x + right.x, left.y + right.y);
 }
 
 // Subtracting a vector from a vector creates a new vector
-inline constexpr Vector2 operator -(Vector2 left, Vector2 right)
+template< typename T >
+inline constexpr BasicVector2<T> operator -(BasicVector2<T> left, BasicVector2<T> right)
 {
-	return Vector2(left.x - right.x, left.y - right.y);
+	return BasicVector2<T>(left.x - right.x, left.y - right.y);
 }
 
 // Multiplying a vector by a factor scales the vector
-inline constexpr Vector2 operator *(Vector2 vector, Number factor)
+// (The factor's type is taken from the vector, so integers and literals convert to it)
+template< typename T >
+inline constexpr BasicVector2<T> operator *(BasicVector2<T> vector, typename BasicVector2<T>::Scalar factor)
+{
+	return BasicVector2<T>(vector.x * factor, vector.y * factor);
+}
+
+// The dot product is the length of one vector along the other, scaled by the other's length
+template< typename T >
+inline constexpr T dotProduct(BasicVector2<T> left, BasicVector2<T> right)
 {
-	return Vector2(vector.x * factor, vector.y * factor);
+	return ((left.x * right.x) + (left.y * right.y));
 }
 
 // Dividing a vector by a factor scales the vector
-inline constexpr Vector2 operator /(Vector2 vector, Number factor)
+template< typename T >
+inline constexpr BasicVector2<T> operator /(BasicVector2<T> vector, typename BasicVector2<T>::Scalar factor)
 {
 	// Multiplying by the inverse might be cheaper
 	return vector * (1 / factor);
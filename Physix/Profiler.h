@@ -0,0 +1,204 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/// The stages of a frame that are timed by the profiler.
+enum class ProfileStage : uint8_t
+{
+	Input,
+	Physics,
+	Render,
+	Display,
+};
+
+/// The number of stages in `ProfileStage`.
+constexpr uint8_t profileStageCount = 4;
+
+/// Timing statistics for one stage, in microseconds.
+struct ProfileStatistics
+{
+	uint16_t minimum;
+	uint16_t average;
+	uint16_t maximum;
+};
+
+/// Times each stage of a frame using `micros()`.
+///
+/// Statistics are gathered over a window of frames,
+/// and the statistics of the last complete window are kept for display.
+///
+/// `Profiler<false>` does nothing at all,
+/// so disabling profiling removes its cost entirely.
+template< bool enabled >
+class Profiler;
+
+template<>
+class Profiler<true>
+{
+public:
+	/// The number of frames statistics are gathered over.
+	///
+	/// Must be a power of two so that the average is a shift rather than a division.
+	static constexpr uint8_t windowShift = 5;
+	static constexpr uint8_t windowSize = (1 << windowShift);
+
+	/// Indicates whether the profiler does anything.
+	static constexpr bool isEnabled = true;
+
+private:
+	/// Statistics for the window currently being gathered.
+	struct Accumulator
+	{
+		uint16_t minimum = UINT16_MAX;
+		uint16_t maximum = 0;
+		uint32_t total = 0;
+
+		void add(uint16_t sample)
+		{
+			if(sample < minimum)
+				minimum = sample;
+
+			if(sample > maximum)
+				maximum = sample;
+
+			total += sample;
+		}
+
+		ProfileStatistics finish()
+		{
+			const ProfileStatistics result { minimum, static_cast<uint16_t>(total >> windowShift), maximum };
+
+			minimum = UINT16_MAX;
+			maximum = 0;
+			total = 0;
+
+			return result;
+		}
+	};
+
+	/// The time at which the current stage started.
+	uint32_t stageStart = 0;
+
+	/// The time spent in the current frame so far.
+	uint16_t frameTotal = 0;
+
+	/// The time each stage took in the current frame, or the last frame it ran in.
+	uint16_t stageTimes[profileStageCount] {};
+
+	/// The number of frames gathered so far in the current window.
+	uint8_t frameCount = 0;
+
+	/// The statistics for each stage, followed by the whole frame.
+	Accumulator accumulators[profileStageCount + 1];
+	ProfileStatistics statistics[profileStageCount + 1] {};
+
+public:
+	/// Marks the start of a frame.
+	void beginFrame()
+	{
+		stageStart = micros();
+		frameTotal = 0;
+	}
+
+	/// Marks the end of a stage, which is also the start of the next stage.
+	void endStage(ProfileStage stage)
+	{
+		const uint32_t now = micros();
+		const auto duration = static_cast<uint16_t>(now - stageStart);
+
+		stageStart = now;
+		frameTotal += duration;
+		stageTimes[static_cast<uint8_t>(stage)] = duration;
+
+		accumulators[static_cast<uint8_t>(stage)].add(duration);
+	}
+
+	/// Marks the end of a frame.
+	void endFrame()
+	{
+		accumulators[profileStageCount].add(frameTotal);
+
+		++frameCount;
+
+		// If the window is complete...
+		if(frameCount >= windowSize)
+		{
+			frameCount = 0;
+
+			// Keep the window's statistics, and start a new window.
+			for(uint8_t index = 0; index < (profileStageCount + 1); ++index)
+				statistics[index] = accumulators[index].finish();
+		}
+	}
+
+	/// Gets the time spent in the current frame so far, in microseconds.
+	///
+	/// After `endFrame`, this is the time the whole frame took.
+	uint16_t getFrameTime() const
+	{
+		return frameTotal;
+	}
+
+	/// Gets the time the specified stage took in the current frame, in microseconds.
+	///
+	/// A stage that was skipped this frame still has the time from the last frame it ran in.
+	uint16_t getStageTime(ProfileStage stage) const
+	{
+		return stageTimes[static_cast<uint8_t>(stage)];
+	}
+
+	/// Gets the statistics of the last complete window for the specified stage.
+	const ProfileStatistics & getStatistics(ProfileStage stage) const
+	{
+		return statistics[static_cast<uint8_t>(stage)];
+	}
+
+	/// Gets the statistics of the last complete window for the whole frame.
+	const ProfileStatistics & getFrameStatistics() const
+	{
+		return statistics[profileStageCount];
+	}
+
+	/// Gets the average percentage of each frame spent working
+	/// during the last complete window.
+	uint16_t getCpuLoad(uint8_t frameRate) const
+	{
+		// frameTime / (1000000 / frameRate) * 100
+		return static_cast<uint16_t>((static_cast<uint32_t>(getFrameStatistics().average) * frameRate) / 10000);
+	}
+};
+
+template<>
+class Profiler<false>
+{
+public:
+	static constexpr bool isEnabled = false;
+
+	void beginFrame() {}
+	void endStage(ProfileStage) {}
+	void endFrame() {}
+
+	uint16_t getFrameTime() const { return 0; }
+	uint16_t getStageTime(ProfileStage) const { return 0; }
+
+	ProfileStatistics getStatistics(ProfileStage) const { return ProfileStatistics {}; }
+	ProfileStatistics getFrameStatistics() const { return ProfileStatistics {}; }
+	uint16_t getCpuLoad(uint8_t) const { return 0; }
+};
\ No newline at end of file
@@ -0,0 +1,397 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Arduboy2.h>
+
+#include "Save.h"
+
+/// What is done with the player's input.
+enum class ReplayMode : uint8_t
+{
+	/// Input is used as it is.
+	Off,
+
+	/// Input is recorded to EEPROM as it is used.
+	Record,
+
+	/// Input is replaced by the input recorded in EEPROM.
+	Playback,
+};
+
+/// The layout of a recording in EEPROM.
+///
+/// A recording is the random seed followed by a series of runs,
+/// which can fill EEPROM up to the space set aside for saves.
+/// Each run is a button state and the number of consecutive frames it lasted for,
+/// so held buttons take two bytes no matter how long they are held for.
+struct ReplayFormat
+{
+	/// The first byte of EEPROM that belongs to this game.
+	static constexpr uint16_t start = EEPROM_STORAGE_SPACE_START;
+
+	/// Marks the start of a valid recording.
+	static constexpr uint8_t signature0 = 'P';
+	static constexpr uint8_t signature1 = 'X';
+
+	static constexpr uint16_t signatureOffset = (start + 0);
+	static constexpr uint16_t seedOffset = (start + 2);
+	static constexpr uint16_t runCountOffset = (start + 6);
+	static constexpr uint16_t runsOffset = (start + 8);
+
+	/// The size of a single run, in bytes.
+	static constexpr uint8_t runSize = 2;
+
+	/// The longest a single run can be, in frames.
+	static constexpr uint8_t maximumRunLength = UINT8_MAX;
+
+	/// The most frames the run being recorded goes without being written,
+	/// so switching off while a button is held loses at most a second of it.
+	static constexpr uint8_t flushInterval = 60;
+
+	/// Gets the number of runs that fit in EEPROM.
+	static uint16_t getRunCapacity()
+	{
+		return ((SaveFormat::getStart() - runsOffset) / runSize);
+	}
+
+	/// Indicates whether EEPROM holds a valid recording.
+	static bool hasRecording()
+	{
+		return ((EEPROM.read(signatureOffset) == signature0) && (EEPROM.read(signatureOffset + 1) == signature1));
+	}
+
+	/// Gets the number of runs in the recording,
+	/// guarding against a corrupted count.
+	static uint16_t getRunCount()
+	{
+		uint16_t runCount;
+		EEPROM.get(runCountOffset, runCount);
+
+		const uint16_t capacity = getRunCapacity();
+
+		return (runCount < capacity) ? runCount : capacity;
+	}
+
+	/// Gets the address of the specified run.
+	static constexpr uint16_t getRunAddress(uint16_t index)
+	{
+		return (runsOffset + (index * runSize));
+	}
+};
+
+/// Records or plays back the buttons pressed on each frame.
+///
+/// The game passes the buttons read each frame through `update`
+/// and uses the buttons it returns instead,
+/// then calls `flush` once the frame is done,
+/// which writes to EEPROM only when a run of input ends or has gone unwritten for a while.
+///
+/// `Replay<ReplayMode::Off>` does nothing at all,
+/// so disabling replays removes their cost entirely.
+template< ReplayMode mode >
+class Replay;
+
+template<>
+class Replay<ReplayMode::Off>
+{
+public:
+	static constexpr ReplayMode replayMode = ReplayMode::Off;
+
+	/// Gets the seed to use for the random number generator.
+	uint32_t begin(uint32_t seed)
+	{
+		return seed;
+	}
+
+	/// Gets the buttons to use for this frame.
+	uint8_t update(uint8_t buttons)
+	{
+		return buttons;
+	}
+
+	/// Writes anything that's waiting to EEPROM.
+	void flush()
+	{
+	}
+
+	/// Indicates whether input is being recorded or played back.
+	bool isActive() const
+	{
+		return false;
+	}
+};
+
+template<>
+class Replay<ReplayMode::Record>
+{
+public:
+	static constexpr ReplayMode replayMode = ReplayMode::Record;
+
+private:
+	/// The number of runs that have finished.
+	uint16_t runCount = 0;
+
+	/// The button state of the current run.
+	uint8_t runButtons = 0;
+
+	/// The length of the current run, in frames.
+	uint8_t runLength = 0;
+
+	/// The run that ended during the last update, which hasn't been written yet.
+	uint8_t endedButtons = 0;
+	uint8_t endedLength = 0;
+	bool runEnded = false;
+
+	/// The number of frames since anything was written.
+	uint8_t framesSinceFlush = 0;
+
+	/// Indicates whether there's still room to record.
+	bool active = false;
+
+public:
+	/// Starts a new recording.
+	///
+	/// Returns the seed to use for the random number generator.
+	uint32_t begin(uint32_t seed)
+	{
+		// Invalidate the old recording until the header has been rewritten.
+		EEPROM.update(ReplayFormat::signatureOffset, 0);
+
+		EEPROM.put(ReplayFormat::seedOffset, seed);
+		EEPROM.put(ReplayFormat::runCountOffset, static_cast<uint16_t>(0));
+
+		EEPROM.update(ReplayFormat::signatureOffset + 1, ReplayFormat::signature1);
+		EEPROM.update(ReplayFormat::signatureOffset, ReplayFormat::signature0);
+
+		runCount = 0;
+		runButtons = 0;
+		runLength = 0;
+		runEnded = false;
+		framesSinceFlush = 0;
+		active = true;
+
+		return seed;
+	}
+
+	/// Records the buttons for this frame.
+	///
+	/// Nothing is written to EEPROM until `flush` is called.
+	/// Returns the buttons unchanged.
+	uint8_t update(uint8_t buttons)
+	{
+		if(!active)
+			return buttons;
+
+		// If the current run has ended...
+		if((runLength > 0) && ((buttons != runButtons) || (runLength == ReplayFormat::maximumRunLength)))
+		{
+			// Keep it for the next flush, and move on to the next run.
+			endedButtons = runButtons;
+			endedLength = runLength;
+			runEnded = true;
+
+			++runCount;
+			runLength = 0;
+
+			// Stop recording once EEPROM is full.
+			if(runCount >= ReplayFormat::getRunCapacity())
+				active = false;
+		}
+
+		// If there's no room left...
+		if(!active)
+			return buttons;
+
+		// If this frame starts a new run...
+		if(runLength == 0)
+			runButtons = buttons;
+
+		++runLength;
+
+		if(framesSinceFlush < UINT8_MAX)
+			++framesSinceFlush;
+
+		return buttons;
+	}
+
+	/// Writes the recording to EEPROM, if it's due.
+	///
+	/// A run is written when it ends, including the last run when EEPROM fills up.
+	/// The run still being recorded is also written every `ReplayFormat::flushInterval` frames,
+	/// so that switching off only loses the frames since then.
+	/// Most frames write nothing, because each write takes over 3ms.
+	void flush()
+	{
+		// If a run has ended...
+		if(runEnded)
+		{
+			// Write it, and stop counting the run in progress.
+			writeRun(runCount - 1, endedButtons, endedLength);
+			writeRunCount(runCount);
+
+			runEnded = false;
+			framesSinceFlush = 0;
+			return;
+		}
+
+		// If the run in progress hasn't been written for a while...
+		if(active && (runLength > 0) && (framesSinceFlush >= ReplayFormat::flushInterval))
+		{
+			// Write it as far as it has got, and count it.
+			writeRun(runCount, runButtons, runLength);
+			writeRunCount(runCount + 1);
+
+			framesSinceFlush = 0;
+		}
+	}
+
+	/// Indicates whether input is still being recorded.
+	bool isActive() const
+	{
+		return active;
+	}
+
+private:
+	static void writeRun(uint16_t index, uint8_t buttons, uint8_t length)
+	{
+		const uint16_t address = ReplayFormat::getRunAddress(index);
+
+		EEPROM.update(address, buttons);
+		EEPROM.update(address + 1, length);
+	}
+
+	static void writeRunCount(uint16_t count)
+	{
+		EEPROM.put(ReplayFormat::runCountOffset, count);
+	}
+};
+
+template<>
+class Replay<ReplayMode::Playback>
+{
+public:
+	static constexpr ReplayMode replayMode = ReplayMode::Playback;
+
+private:
+	/// The number of runs in the recording.
+	uint16_t runCount = 0;
+
+	/// The index of the current run.
+	uint16_t runIndex = 0;
+
+	/// The button state of the current run.
+	uint8_t runButtons = 0;
+
+	/// The number of frames left in the current run.
+	uint8_t framesRemaining = 0;
+
+public:
+	/// Starts playing back the recording.
+	///
+	/// Returns the seed that the recording was made with,
+	/// or the specified seed if there's no valid recording.
+	uint32_t begin(uint32_t seed)
+	{
+		runCount = 0;
+		runIndex = 0;
+		framesRemaining = 0;
+
+		// If there's no recording...
+		if(!ReplayFormat::hasRecording())
+			// Play nothing back.
+			return seed;
+
+		EEPROM.get(ReplayFormat::seedOffset, seed);
+		runCount = ReplayFormat::getRunCount();
+
+		return seed;
+	}
+
+	/// Gets the recorded buttons for this frame.
+	///
+	/// Once the recording has finished, the buttons are passed through unchanged.
+	uint8_t update(uint8_t buttons)
+	{
+		// While the current run has finished...
+		// (Runs should never be empty, but skipping them costs nothing.)
+		while(framesRemaining == 0)
+		{
+			// If the recording has finished...
+			if(runIndex >= runCount)
+				return buttons;
+
+			// Read the next run.
+			const uint16_t address = ReplayFormat::getRunAddress(runIndex);
+
+			runButtons = EEPROM.read(address);
+			framesRemaining = EEPROM.read(address + 1);
+
+			++runIndex;
+		}
+
+		--framesRemaining;
+
+		return runButtons;
+	}
+
+	/// Writes anything that's waiting to EEPROM.
+	void flush()
+	{
+	}
+
+	/// Indicates whether input is still being played back.
+	bool isActive() const
+	{
+		return ((framesRemaining > 0) || (runIndex < runCount));
+	}
+};
+
+/// Writes the recording in EEPROM to the specified output as text,
+/// so that it can be captured over serial.
+///
+/// The seed comes first, then one line per run:
+/// the buttons in hexadecimal followed by the number of frames.
+inline void printReplay(Print & output)
+{
+	// If there's no recording...
+	if(!ReplayFormat::hasRecording())
+	{
+		output.println(F("no replay"));
+		return;
+	}
+
+	uint32_t seed;
+	EEPROM.get(ReplayFormat::seedOffset, seed);
+
+	const uint16_t runCount = ReplayFormat::getRunCount();
+
+	output.print(F("seed "));
+	output.println(seed);
+
+	for(uint16_t index = 0; index < runCount; ++index)
+	{
+		const uint16_t address = ReplayFormat::getRunAddress(index);
+
+		output.print(EEPROM.read(address), HEX);
+		output.print(' ');
+		output.println(EEPROM.read(address + 1));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,445 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "Physics.h"
+#include "Scene.h"
+#include "Varint.h"
+
+/// The layout of the saved tuning and snapshot in EEPROM.
+///
+/// They're kept together at the end of EEPROM, after the space used by replays.
+///
+/// The tuning is a signature followed by the friction, gravity,
+/// restitution and input force, each as the raw value of a `Number`.
+///
+/// The snapshot is a signature, the number of bodies and the number of bytes they take,
+/// followed by each body in turn: its flags, its size, its position, its velocity and its inverse mass.
+/// A body that isn't on every collision layer, or doesn't collide with every layer,
+/// also has its layers and collision mask after its size.
+/// Positions are stored as the difference from the previous body's position,
+/// and every number is stored as a varint (see Varint.h), so small numbers take fewer bytes.
+struct SaveFormat
+{
+	/// The number of bytes set aside for saves, at the end of EEPROM.
+	static constexpr uint16_t size = 256;
+
+	/// Marks the start of valid tuning.
+	static constexpr uint8_t tuningSignature0 = 'P';
+	static constexpr uint8_t tuningSignature1 = 'T';
+
+	/// Marks the start of a valid snapshot.
+	static constexpr uint8_t snapshotSignature0 = 'P';
+	static constexpr uint8_t snapshotSignature1 = 'S';
+
+	// Offsets from the start of the saves.
+	static constexpr uint8_t tuningSignatureOffset = 0;
+	static constexpr uint8_t tuningValuesOffset = 2;
+	static constexpr uint8_t tuningSize = (tuningValuesOffset + (4 * sizeof(int16_t)));
+
+	static constexpr uint8_t snapshotSignatureOffset = tuningSize;
+	static constexpr uint8_t snapshotBodyCountOffset = (snapshotSignatureOffset + 2);
+	static constexpr uint8_t snapshotLengthOffset = (snapshotBodyCountOffset + 1);
+	static constexpr uint8_t snapshotBodiesOffset = (snapshotLengthOffset + 1);
+
+	/// The most bytes the snapshot's bodies can take.
+	static constexpr uint8_t snapshotCapacity = static_cast<uint8_t>(size - snapshotBodiesOffset);
+
+	// Bits of a body's flags.
+	static constexpr uint8_t circleFlag = (1 << 0);
+	static constexpr uint8_t staticFlag = (1 << 1);
+	static constexpr uint8_t layersFlag = (1 << 2);
+	static constexpr uint8_t triggerFlag = (1 << 3);
+
+	/// Gets the address of the first byte set aside for saves.
+	static uint16_t getStart()
+	{
+		return (EEPROM.length() - size);
+	}
+
+	/// Indicates whether EEPROM holds valid tuning.
+	static bool hasTuning()
+	{
+		const uint16_t address = (getStart() + tuningSignatureOffset);
+
+		return ((EEPROM.read(address) == tuningSignature0) && (EEPROM.read(address + 1) == tuningSignature1));
+	}
+
+	/// Indicates whether EEPROM holds a valid snapshot.
+	static bool hasSnapshot()
+	{
+		const uint16_t address = (getStart() + snapshotSignatureOffset);
+
+		return ((EEPROM.read(address) == snapshotSignature0) && (EEPROM.read(address + 1) == snapshotSignature1));
+	}
+};
+
+/// Writes bytes to EEPROM, one after another, up to an end address.
+///
+/// Bytes are written with `EEPROM.update`,
+/// so bytes that haven't changed since the last save aren't written again,
+/// which saves both time and wear.
+class SaveWriter
+{
+private:
+	uint16_t address;
+	uint16_t end;
+	bool overflowed = false;
+
+public:
+	SaveWriter(uint16_t address, uint16_t end) :
+		address { address }, end { end }
+	{
+	}
+
+	/// Gets the address of the next byte to be written.
+	uint16_t getAddress() const
+	{
+		return this->address;
+	}
+
+	/// Indicates whether anything was left out because it didn't fit.
+	bool hasOverflowed() const
+	{
+		return this->overflowed;
+	}
+
+	void writeByte(uint8_t value)
+	{
+		if(this->address >= this->end)
+		{
+			this->overflowed = true;
+			return;
+		}
+
+		EEPROM.update(this->address, value);
+		++this->address;
+	}
+
+	void writeVarint(uint16_t value)
+	{
+		::writeVarint(*this, value);
+	}
+
+	void writeSigned(int16_t value)
+	{
+		::writeVarint(*this, encodeZigzag(value));
+	}
+};
+
+/// Counts the bytes a `SaveWriter` would write, without writing anything,
+/// so that a save can be checked to fit before anything is overwritten.
+class SaveMeasurer
+{
+private:
+	uint16_t size = 0;
+	uint16_t capacity;
+
+public:
+	explicit SaveMeasurer(uint16_t capacity) :
+		capacity { capacity }
+	{
+	}
+
+	/// Gets the number of bytes that would have been written.
+	uint16_t getSize() const
+	{
+		return this->size;
+	}
+
+	/// Indicates whether the bytes wouldn't fit.
+	bool hasOverflowed() const
+	{
+		return (this->size > this->capacity);
+	}
+
+	void writeByte(uint8_t)
+	{
+		++this->size;
+	}
+
+	void writeVarint(uint16_t value)
+	{
+		::writeVarint(*this, value);
+	}
+
+	void writeSigned(int16_t value)
+	{
+		::writeVarint(*this, encodeZigzag(value));
+	}
+};
+
+/// Reads bytes written by a `SaveWriter`.
+class SaveReader
+{
+private:
+	uint16_t address;
+	uint16_t end;
+	bool overflowed = false;
+
+public:
+	SaveReader(uint16_t address, uint16_t end) :
+		address { address }, end { end }
+	{
+	}
+
+	/// Indicates whether reading went past the end, so the data was corrupt.
+	bool hasOverflowed() const
+	{
+		return this->overflowed;
+	}
+
+	uint8_t readByte()
+	{
+		if(this->address >= this->end)
+		{
+			this->overflowed = true;
+			return 0;
+		}
+
+		const uint8_t value = EEPROM.read(this->address);
+		++this->address;
+		return value;
+	}
+
+	uint16_t readVarint()
+	{
+		return ::readVarint(*this);
+	}
+
+	int16_t readSigned()
+	{
+		return decodeZigzag(::readVarint(*this));
+	}
+};
+
+/// Saves the tuned coefficients to EEPROM.
+///
+/// Only the bytes that have changed are written,
+/// so saving tuning that hasn't changed costs nothing.
+inline void saveTuning(const SceneCoefficients & coefficients, Number inputForce)
+{
+	const uint16_t start = SaveFormat::getStart();
+	const uint16_t values = (start + SaveFormat::tuningValuesOffset);
+
+	// Invalidate the old tuning until the new tuning has been written.
+	EEPROM.update(start + SaveFormat::tuningSignatureOffset, 0);
+
+	EEPROM.put(values + 0, coefficients.friction.getInternal());
+	EEPROM.put(values + 2, coefficients.gravity.getInternal());
+	EEPROM.put(values + 4, coefficients.restitution.getInternal());
+	EEPROM.put(values + 6, inputForce.getInternal());
+
+	EEPROM.update(start + SaveFormat::tuningSignatureOffset + 1, SaveFormat::tuningSignature1);
+	EEPROM.update(start + SaveFormat::tuningSignatureOffset, SaveFormat::tuningSignature0);
+}
+
+/// Loads the tuned coefficients from EEPROM.
+///
+/// Returns false, leaving them as they are, if nothing has been saved.
+inline bool loadTuning(SceneCoefficients & coefficients, Number & inputForce)
+{
+	if(!SaveFormat::hasTuning())
+		return false;
+
+	const uint16_t values = (SaveFormat::getStart() + SaveFormat::tuningValuesOffset);
+
+	int16_t value;
+
+	coefficients.friction = Number::fromInternal(EEPROM.get(values + 0, value));
+	coefficients.gravity = Number::fromInternal(EEPROM.get(values + 2, value));
+	coefficients.restitution = Number::fromInternal(EEPROM.get(values + 4, value));
+	inputForce = Number::fromInternal(EEPROM.get(values + 6, value));
+
+	return true;
+}
+
+/// Writes every body in the world through a `SaveWriter` or a `SaveMeasurer`.
+template< typename World, typename Writer >
+void writeSnapshotBodies(const World & world, Writer & writer)
+{
+	const uint8_t count = world.getCount();
+
+	int16_t previousX = 0;
+	int16_t previousY = 0;
+
+	for(uint8_t index = 0; index < count; ++index)
+	{
+		uint8_t flags = 0;
+
+		if(world.getShape(index) == BodyShape::Circle)
+			flags |= SaveFormat::circleFlag;
+
+		if(world.isStatic(index))
+			flags |= SaveFormat::staticFlag;
+
+		if(world.isTrigger(index))
+			flags |= SaveFormat::triggerFlag;
+
+		const uint8_t layers = world.getLayers(index);
+		const uint8_t collisionMask = world.getCollisionMask(index);
+
+		// Most bodies collide with everything, so they save two bytes each.
+		const bool hasLayers = ((layers != CollisionLayers::All) || (collisionMask != CollisionLayers::All));
+
+		if(hasLayers)
+			flags |= SaveFormat::layersFlag;
+
+		writer.writeByte(flags);
+		writer.writeByte(world.getSize(index));
+
+		if(hasLayers)
+		{
+			writer.writeByte(layers);
+			writer.writeByte(collisionMask);
+		}
+
+		const int16_t x = world.getX(index).getInternal();
+		const int16_t y = world.getY(index).getInternal();
+
+		writer.writeSigned(x - previousX);
+		writer.writeSigned(y - previousY);
+
+		previousX = x;
+		previousY = y;
+
+		// Static bodies have no velocity or mass to save.
+		if(world.isStatic(index))
+			continue;
+
+		const Vector2 velocity = world.getVelocity(index);
+
+		writer.writeSigned(velocity.x.getInternal());
+		writer.writeSigned(velocity.y.getInternal());
+		writer.writeVarint(static_cast<uint16_t>(world.getInverseMass(index).getInternal()));
+	}
+}
+
+/// Saves every body in the world to EEPROM.
+///
+/// The bodies are measured before anything is written,
+/// so if they don't fit, false is returned and the old snapshot is kept.
+template< typename World >
+bool saveSnapshot(const World & world)
+{
+	SaveMeasurer measurer { SaveFormat::snapshotCapacity };
+	writeSnapshotBodies(world, measurer);
+
+	if(measurer.hasOverflowed())
+		return false;
+
+	const uint16_t start = SaveFormat::getStart();
+	const uint16_t bodies = (start + SaveFormat::snapshotBodiesOffset);
+
+	// Invalidate the old snapshot until the new one has been written.
+	EEPROM.update(start + SaveFormat::snapshotSignatureOffset, 0);
+
+	SaveWriter writer { bodies, static_cast<uint16_t>(bodies + SaveFormat::snapshotCapacity) };
+	writeSnapshotBodies(world, writer);
+
+	const uint8_t count = world.getCount();
+
+	EEPROM.update(start + SaveFormat::snapshotBodyCountOffset, count);
+	EEPROM.update(start + SaveFormat::snapshotLengthOffset, static_cast<uint8_t>(writer.getAddress() - bodies));
+
+	EEPROM.update(start + SaveFormat::snapshotSignatureOffset + 1, SaveFormat::snapshotSignature1);
+	EEPROM.update(start + SaveFormat::snapshotSignatureOffset, SaveFormat::snapshotSignature0);
+
+	return true;
+}
+
+/// Replaces every body in the world with the bodies in the snapshot.
+///
+/// Bodies that don't fit in the world are left out.
+/// Returns false, leaving the world as it is, if there's no snapshot.
+template< typename World >
+bool loadSnapshot(World & world)
+{
+	if(!SaveFormat::hasSnapshot())
+		return false;
+
+	const uint16_t start = SaveFormat::getStart();
+	const uint16_t bodies = (start + SaveFormat::snapshotBodiesOffset);
+
+	const uint8_t bodyCount = EEPROM.read(start + SaveFormat::snapshotBodyCountOffset);
+	const uint8_t length = EEPROM.read(start + SaveFormat::snapshotLengthOffset);
+
+	SaveReader reader { bodies, static_cast<uint16_t>(bodies + length) };
+
+	world.clear();
+
+	int16_t x = 0;
+	int16_t y = 0;
+
+	for(uint8_t count = 0; count < bodyCount; ++count)
+	{
+		const uint8_t flags = reader.readByte();
+		const uint8_t size = reader.readByte();
+
+		uint8_t layers = CollisionLayers::All;
+		uint8_t collisionMask = CollisionLayers::All;
+
+		if((flags & SaveFormat::layersFlag) != 0)
+		{
+			layers = reader.readByte();
+			collisionMask = reader.readByte();
+		}
+
+		x += reader.readSigned();
+		y += reader.readSigned();
+
+		const bool isStatic = ((flags & SaveFormat::staticFlag) != 0);
+
+		const int16_t velocityX = isStatic ? 0 : reader.readSigned();
+		const int16_t velocityY = isStatic ? 0 : reader.readSigned();
+		const uint16_t inverseMass = isStatic ? 0 : reader.readVarint();
+
+		// If the snapshot is corrupt...
+		if(reader.hasOverflowed())
+			// Leave out the rest.
+			break;
+
+		const uint8_t handle = world.spawn();
+
+		// If the world is full...
+		if(handle == World::invalidHandle)
+			// Leave out the rest.
+			break;
+
+		const uint8_t index = world.getIndex(handle);
+
+		world.setShape(index, ((flags & SaveFormat::circleFlag) != 0) ? BodyShape::Circle : BodyShape::Box, size);
+		world.setPosition(index, Point2(Number::fromInternal(x), Number::fromInternal(y)));
+		world.setLayers(index, layers, collisionMask);
+		world.setTrigger(index, ((flags & SaveFormat::triggerFlag) != 0));
+
+		if(isStatic)
+		{
+			world.makeStatic(index);
+			continue;
+		}
+
+		world.setVelocity(index, Vector2(Number::fromInternal(velocityX), Number::fromInternal(velocityY)));
+		world.setInverseMass(index, Number::fromInternal(static_cast<int16_t>(inverseMass)));
+	}
+
+	return true;
+}
\ No newline at end of file
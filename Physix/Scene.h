@@ -0,0 +1,354 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <Arduboy2.h>
+
+#include "Physics.h"
+
+/// The layout of a scene in flash.
+///
+/// A scene is a header, followed by its static shapes and then its bodies.
+/// Every field is a single byte, and positions are whole pixels.
+///
+/// The header holds the number of bodies, the number of shapes,
+/// and the coefficients of friction, gravity and restitution,
+/// each as a fraction of 256.
+///
+/// Each shape is its kind (a `BodyShape`), its position and its width and height.
+/// A circle's diameter is its width.
+///
+/// Each body is its kind, its size, its position, its velocity and its mass.
+/// Velocities have four fractional bits, and a mass of zero makes the body static.
+struct SceneFormat
+{
+	static constexpr uint8_t bodyCountOffset = 0;
+	static constexpr uint8_t shapeCountOffset = 1;
+	static constexpr uint8_t frictionOffset = 2;
+	static constexpr uint8_t gravityOffset = 3;
+	static constexpr uint8_t restitutionOffset = 4;
+	static constexpr uint8_t headerSize = 5;
+
+	static constexpr uint8_t shapeKindOffset = 0;
+	static constexpr uint8_t shapeXOffset = 1;
+	static constexpr uint8_t shapeYOffset = 2;
+	static constexpr uint8_t shapeWidthOffset = 3;
+	static constexpr uint8_t shapeHeightOffset = 4;
+	static constexpr uint8_t shapeSize = 5;
+
+	static constexpr uint8_t bodyKindOffset = 0;
+	static constexpr uint8_t bodySizeOffset = 1;
+	static constexpr uint8_t bodyXOffset = 2;
+	static constexpr uint8_t bodyYOffset = 3;
+	static constexpr uint8_t bodyVelocityXOffset = 4;
+	static constexpr uint8_t bodyVelocityYOffset = 5;
+	static constexpr uint8_t bodyMassOffset = 6;
+	static constexpr uint8_t bodySize = 7;
+
+	/// The number of fractional bits in a body's velocity.
+	static constexpr uint8_t velocityFractionSize = 4;
+
+	/// The mass of a static body.
+	static constexpr uint8_t staticMass = 0;
+
+	/// Gets the address of the first shape.
+	static const uint8_t * getShapes(const uint8_t * scene)
+	{
+		return &scene[headerSize];
+	}
+
+	/// Gets the address of the first body.
+	static const uint8_t * getBodies(const uint8_t * scene)
+	{
+		return &scene[headerSize + (pgm_read_byte(&scene[shapeCountOffset]) * shapeSize)];
+	}
+
+	/// Reads a coefficient from the header.
+	static Number readCoefficient(const uint8_t * scene, uint8_t offset)
+	{
+		return numberCast<Number>(UFixed<0, 8>::fromInternal(pgm_read_byte(&scene[offset])));
+	}
+
+	/// Reads a velocity from a body.
+	static Number readVelocity(const uint8_t * body, uint8_t offset)
+	{
+		using Velocity = SFixed<3, velocityFractionSize>;
+
+		return numberCast<Number>(Velocity::fromInternal(static_cast<int8_t>(pgm_read_byte(&body[offset]))));
+	}
+};
+
+/// The grid that a scene's static shapes are indexed by.
+///
+/// Each cell has a mask of the shapes that overlap it,
+/// so a body only has to test the shapes in the cells it covers.
+/// Shapes that are partly off screen are counted as being in the edge cells,
+/// because that's where bodies that leave the screen are looked up.
+struct SceneGrid
+{
+	/// A set of shapes, one bit per shape.
+	using Mask = uint16_t;
+
+	/// The most shapes that a scene can have.
+	static constexpr uint8_t maximumShapes = 16;
+
+	static constexpr uint8_t cellShift = 4;
+	static constexpr uint8_t cellSize = (1 << cellShift);
+	static constexpr uint8_t columns = (WIDTH / cellSize);
+	static constexpr uint8_t rows = (HEIGHT / cellSize);
+	static constexpr uint8_t cellCount = (columns * rows);
+
+	/// Gets the column that contains the specified x coordinate, clamped to the grid.
+	static constexpr uint8_t getColumn(int16_t x)
+	{
+		return clampCell(x, columns);
+	}
+
+	/// Gets the row that contains the specified y coordinate, clamped to the grid.
+	static constexpr uint8_t getRow(int16_t y)
+	{
+		return clampCell(y, rows);
+	}
+
+	/// Gets the index of the specified cell.
+	static constexpr uint8_t getCell(uint8_t column, uint8_t row)
+	{
+		return ((row * columns) + column);
+	}
+
+	/// Gets the mask of the shapes in a scene that overlap the specified cell.
+	///
+	/// This reads the scene directly rather than from flash,
+	/// so it's only meant to be evaluated at compile time, by `SceneIndex`.
+	static constexpr Mask getCellMask(const uint8_t * scene, uint8_t cell, uint8_t shape = 0)
+	{
+		return (shape >= scene[SceneFormat::shapeCountOffset]) ? 0 :
+			(
+				(overlapsCell(&scene[SceneFormat::headerSize + (shape * SceneFormat::shapeSize)], (cell % columns), (cell / columns)) ? static_cast<Mask>(1u << shape) : 0) |
+				getCellMask(scene, cell, (shape + 1))
+			);
+	}
+
+private:
+	static constexpr uint8_t clampCell(int16_t position, uint8_t count)
+	{
+		return (position < 0) ? 0 : ((position >> cellShift) < count) ? static_cast<uint8_t>(position >> cellShift) : (count - 1);
+	}
+
+	// A circle's bounding box is as tall as it is wide.
+	static constexpr uint8_t getShapeHeight(const uint8_t * shape)
+	{
+		return (shape[SceneFormat::shapeKindOffset] == static_cast<uint8_t>(BodyShape::Circle)) ? shape[SceneFormat::shapeWidthOffset] : shape[SceneFormat::shapeHeightOffset];
+	}
+
+	static constexpr bool overlapsCell(const uint8_t * shape, uint8_t column, uint8_t row)
+	{
+		return
+			(getColumn(static_cast<int8_t>(shape[SceneFormat::shapeXOffset])) <= column) &&
+			(getColumn(static_cast<int8_t>(shape[SceneFormat::shapeXOffset]) + shape[SceneFormat::shapeWidthOffset] - 1) >= column) &&
+			(getRow(static_cast<int8_t>(shape[SceneFormat::shapeYOffset])) <= row) &&
+			(getRow(static_cast<int8_t>(shape[SceneFormat::shapeYOffset]) + getShapeHeight(shape) - 1) >= row);
+	}
+};
+
+/// A list of cell indices, used to build a `SceneIndex` one cell at a time.
+template< uint8_t ... indices >
+struct CellSequence
+{
+};
+
+template< uint8_t count, uint8_t ... indices >
+struct MakeCellSequence : MakeCellSequence<(count - 1), (count - 1), indices ...>
+{
+};
+
+template< uint8_t ... indices >
+struct MakeCellSequence<0, indices ...>
+{
+	using Type = CellSequence<indices ...>;
+};
+
+/// The index of a scene's static shapes, built at compile time and kept in flash.
+///
+/// `SceneIndex<scene>::cells` is the mask of shapes in each cell of the `SceneGrid`,
+/// which costs two bytes of flash per cell and no RAM at all.
+template< const uint8_t * scene, typename Cells = typename MakeCellSequence<SceneGrid::cellCount>::Type >
+struct SceneIndex;
+
+template< const uint8_t * scene, uint8_t ... indices >
+struct SceneIndex<scene, CellSequence<indices ...>>
+{
+	static_assert(scene[SceneFormat::shapeCountOffset] <= SceneGrid::maximumShapes, "A scene can only have as many shapes as a SceneGrid::Mask has bits");
+
+	static constexpr SceneGrid::Mask cells[SceneGrid::cellCount] PROGMEM { SceneGrid::getCellMask(scene, indices) ... };
+};
+
+template< const uint8_t * scene, uint8_t ... indices >
+constexpr SceneGrid::Mask SceneIndex<scene, CellSequence<indices ...>>::cells[SceneGrid::cellCount] PROGMEM;
+
+/// A scene in flash, along with the index of its static shapes.
+struct Scene
+{
+	/// The scene itself, in the layout described by `SceneFormat`.
+	const uint8_t * data;
+
+	/// The scene's `SceneIndex<data>::cells`.
+	const SceneGrid::Mask * index;
+};
+
+/// The absence of a scene.
+constexpr Scene noScene { nullptr, nullptr };
+
+/// Indicates whether a scene is actually a scene, rather than `noScene`.
+constexpr bool isScene(Scene scene)
+{
+	return (scene.data != nullptr);
+}
+
+/// The coefficients that each scene can choose for itself.
+struct SceneCoefficients
+{
+	Number friction;
+	Number gravity;
+	Number restitution;
+};
+
+/// The static shapes of a scene, which are read from flash in place,
+/// so they take no RAM no matter how many there are.
+class SceneGeometry
+{
+public:
+	using Mask = SceneGrid::Mask;
+
+private:
+	const uint8_t * shapes = nullptr;
+	const Mask * index = nullptr;
+	uint8_t count = 0;
+
+public:
+	constexpr SceneGeometry() = default;
+
+	/// Gets the geometry of a scene in flash.
+	SceneGeometry(Scene scene) :
+		shapes { SceneFormat::getShapes(scene.data) },
+		index { scene.index },
+		count { pgm_read_byte(&scene.data[SceneFormat::shapeCountOffset]) }
+	{
+	}
+
+	uint8_t getCount() const
+	{
+		return this->count;
+	}
+
+	/// Gets the shapes that might overlap the specified box,
+	/// from the index cells that the box covers.
+	///
+	/// The right and bottom edges are treated as inclusive,
+	/// so that a box with a fractional position is never under-covered.
+	Mask getShapesNear(int16_t x, int16_t y, uint8_t width, uint8_t height) const
+	{
+		// If there are no shapes, there's no index either.
+		if(this->count == 0)
+			return 0;
+
+		const uint8_t left = SceneGrid::getColumn(x);
+		const uint8_t right = SceneGrid::getColumn(x + width);
+		const uint8_t top = SceneGrid::getRow(y);
+		const uint8_t bottom = SceneGrid::getRow(y + height);
+
+		Mask mask = 0;
+
+		for(uint8_t row = top; row <= bottom; ++row)
+		{
+			const Mask * cell = &this->index[SceneGrid::getCell(left, row)];
+
+			for(uint8_t column = left; column <= right; ++column, ++cell)
+				mask |= pgm_read_word(cell);
+		}
+
+		return mask;
+	}
+
+	StaticShape getShape(uint8_t index) const
+	{
+		const uint8_t * shape = &this->shapes[index * SceneFormat::shapeSize];
+
+		return StaticShape
+		(
+			static_cast<BodyShape>(pgm_read_byte(&shape[SceneFormat::shapeKindOffset])),
+			static_cast<int8_t>(pgm_read_byte(&shape[SceneFormat::shapeXOffset])),
+			static_cast<int8_t>(pgm_read_byte(&shape[SceneFormat::shapeYOffset])),
+			pgm_read_byte(&shape[SceneFormat::shapeWidthOffset]),
+			pgm_read_byte(&shape[SceneFormat::shapeHeightOffset])
+		);
+	}
+};
+
+/// Replaces every body in the world with the bodies of a scene in flash,
+/// reading each one straight into the world.
+///
+/// Bodies that don't fit in the world are left out.
+/// Returns the scene's coefficients.
+template< typename World >
+SceneCoefficients loadScene(Scene scene, World & world)
+{
+	world.clear();
+
+	const uint8_t bodyCount = pgm_read_byte(&scene.data[SceneFormat::bodyCountOffset]);
+	const uint8_t * body = SceneFormat::getBodies(scene.data);
+
+	for(uint8_t count = 0; count < bodyCount; ++count, body += SceneFormat::bodySize)
+	{
+		const uint8_t handle = world.spawn();
+
+		// If the world is full...
+		if(handle == World::invalidHandle)
+			// Leave out the rest.
+			break;
+
+		const uint8_t index = world.getIndex(handle);
+
+		world.setShape(index, static_cast<BodyShape>(pgm_read_byte(&body[SceneFormat::bodyKindOffset])), pgm_read_byte(&body[SceneFormat::bodySizeOffset]));
+
+		const auto x = static_cast<int8_t>(pgm_read_byte(&body[SceneFormat::bodyXOffset]));
+		const auto y = static_cast<int8_t>(pgm_read_byte(&body[SceneFormat::bodyYOffset]));
+
+		world.setPosition(index, Point2(Number(x), Number(y)));
+
+		const uint8_t mass = pgm_read_byte(&body[SceneFormat::bodyMassOffset]);
+
+		// Static bodies don't need a velocity.
+		if(mass == SceneFormat::staticMass)
+		{
+			world.makeStatic(index);
+			continue;
+		}
+
+		world.setMass(index, Number(mass));
+		world.setVelocity(index, Vector2(SceneFormat::readVelocity(body, SceneFormat::bodyVelocityXOffset), SceneFormat::readVelocity(body, SceneFormat::bodyVelocityYOffset)));
+	}
+
+	return SceneCoefficients
+	{
+		SceneFormat::readCoefficient(scene.data, SceneFormat::frictionOffset),
+		SceneFormat::readCoefficient(scene.data, SceneFormat::gravityOffset),
+		SceneFormat::readCoefficient(scene.data, SceneFormat::restitutionOffset),
+	};
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#include "Scene.h"
+
+// Scenes for loadScene, in the layout described by SceneFormat.
+// The game draws every body at its object size, so scene bodies should be that size too.
+//
+// Each scene's data is paired with its SceneIndex in a Scene,
+// which is what the game is given.
+
+// Platforms, a pillar and a peg for objects to fall onto under gravity.
+constexpr uint8_t platformSceneData[] PROGMEM
+{
+	// Bodies, shapes
+	8, 4,
+
+	// Friction (0.95), gravity (0.5), restitution (0.3)
+	243, 128, 76,
+
+	// Shapes: kind, x, y, width, height
+	static_cast<uint8_t>(BodyShape::Box), 8, 40, 40, 4,
+	static_cast<uint8_t>(BodyShape::Box), 80, 24, 40, 4,
+	static_cast<uint8_t>(BodyShape::Box), 60, 8, 8, 16,
+	static_cast<uint8_t>(BodyShape::Circle), 56, 48, 16, 16,
+
+	// Bodies: kind, size, x, y, velocity x, velocity y, mass
+	// (The first body is the player.)
+	static_cast<uint8_t>(BodyShape::Box), 8, 28, 24, 0, 0, 1,
+	static_cast<uint8_t>(BodyShape::Box), 8, 12, 4, 0x10, 0, 1,
+	static_cast<uint8_t>(BodyShape::Circle), 8, 40, 8, 0xF0, 0, 1,
+	static_cast<uint8_t>(BodyShape::Box), 8, 84, 4, 0x08, 0, 1,
+	static_cast<uint8_t>(BodyShape::Circle), 8, 100, 8, 0xF8, 0x08, 1,
+	static_cast<uint8_t>(BodyShape::Circle), 8, 60, 28, 0x04, 0, 1,
+	static_cast<uint8_t>(BodyShape::Box), 8, 92, 40, 0xE0, 0, 1,
+	static_cast<uint8_t>(BodyShape::Circle), 8, 20, 52, 0x20, 0xF0, 2,
+};
+
+constexpr Scene platformScene { platformSceneData, SceneIndex<platformSceneData>::cells };
\ No newline at end of file
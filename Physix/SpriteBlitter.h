@@ -0,0 +1,91 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduboy2.h>
+
+/// Draws sprites of a fixed size straight into the frame buffer.
+///
+/// Sprites are stored in program memory in the same layout as the frame buffer:
+/// one byte per column of eight pixels, with a row of `width` bytes per page.
+///
+/// A sprite whose y position isn't a multiple of eight straddles two pages,
+/// so each sprite column is shifted and written to at most two bytes per page.
+/// Only set pixels are drawn, so sprites can overlap.
+///
+/// Because the size is fixed at compile time,
+/// the loops have constant bounds and all of the clipping is done up front.
+template< uint8_t widthValue, uint8_t heightValue >
+class SpriteBlitter
+{
+public:
+	static constexpr uint8_t width = widthValue;
+	static constexpr uint8_t height = heightValue;
+	static constexpr uint8_t pageCount = (height / 8);
+
+	static_assert((height % 8) == 0, "The height must be a multiple of 8");
+
+	static constexpr uint8_t screenWidth = WIDTH;
+	static constexpr uint8_t screenPageCount = (HEIGHT / 8);
+
+public:
+	/// Draws the specified sprite to the specified frame buffer.
+	///
+	/// Parts of the sprite that are off screen are skipped.
+	static void draw(uint8_t * buffer, int16_t x, int16_t y, const uint8_t * sprite)
+	{
+		// If the sprite is entirely off screen...
+		if((x >= screenWidth) || ((x + width) <= 0) || (y >= HEIGHT) || ((y + height) <= 0))
+			// Draw nothing.
+			return;
+
+		// Find the columns of the sprite that are on screen.
+		const uint8_t firstColumn = (x < 0) ? static_cast<uint8_t>(-x) : 0;
+		const uint8_t endColumn = ((x + width) > screenWidth) ? static_cast<uint8_t>(screenWidth - x) : width;
+
+		// Find the first column of the screen that will be drawn to.
+		const uint8_t left = static_cast<uint8_t>(x + firstColumn);
+
+		// Find how far the sprite is offset from the top of its first page.
+		const uint8_t shift = static_cast<uint8_t>(y & 7);
+
+		// Find the first page the sprite covers, rounding down for negative positions.
+		int8_t page = static_cast<int8_t>((y - shift) / 8);
+
+		for(uint8_t spritePage = 0; spritePage < pageCount; ++spritePage, ++page, sprite += width)
+		{
+			// Draw the upper part of each column in the sprite's page.
+			if((page >= 0) && (page < screenPageCount))
+			{
+				uint8_t * destination = &buffer[(page * screenWidth) + left];
+
+				for(uint8_t column = firstColumn; column < endColumn; ++column)
+					*destination++ |= static_cast<uint8_t>(pgm_read_byte(&sprite[column]) << shift);
+			}
+
+			// Draw the lower part of each column into the page below.
+			if((shift != 0) && ((page + 1) >= 0) && ((page + 1) < screenPageCount))
+			{
+				uint8_t * destination = &buffer[((page + 1) * screenWidth) + left];
+
+				for(uint8_t column = firstColumn; column < endColumn; ++column)
+					*destination++ |= static_cast<uint8_t>(pgm_read_byte(&sprite[column]) >> (8 - shift));
+			}
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,299 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#include "Profiler.h"
+#include "Varint.h"
+
+/// The layout of a telemetry frame.
+///
+/// Each frame is:
+/// - `sync`
+/// - the length of the rest of the frame, not counting the checksum
+/// - the sequence number, which wraps around
+/// - flags
+/// - the number of frames dropped since the last frame was sent
+/// - the frame time in microseconds, as a varint
+/// - the time of each `ProfileStage` in microseconds, as varints
+/// - the number of physics steps taken
+/// - the number of contacts resolved, as a varint
+/// - the number of bodies
+/// - the index of the first body described, and the number of bodies described
+/// - a bitmask of the described bodies that are sleeping, one byte per eight bodies
+/// - for each described body: x, y, vx and vy, as signed varints
+/// - the sum of every byte after the length, modulo 256
+///
+/// A frame describes at most `maximumBodiesPerFrame` bodies,
+/// so larger worlds take turns, a few bodies per frame.
+///
+/// Positions are in whole pixels and velocities are in 1/256 pixels per frame.
+/// In a keyframe positions are absolute,
+/// otherwise they're the difference from the position last sent for the same body.
+/// Tools/telemetry.py decodes and plots frames.
+struct TelemetryFormat
+{
+	static constexpr uint8_t sync = 0xA5;
+
+	/// Marks a frame whose positions are absolute.
+	static constexpr uint8_t keyframeFlag = (1 << 0);
+
+	/// The number of frames between rounds of keyframes,
+	/// so that a decoder can pick up the stream part way through.
+	static constexpr uint8_t keyframeInterval = 60;
+
+	/// The most bodies a single frame describes.
+	static constexpr uint8_t maximumBodiesPerFrame = 8;
+
+	/// The size of a frame that describes nothing but its header, at its largest.
+	static constexpr uint8_t maximumHeaderSize = (10 + ((2 + profileStageCount) * maximumVarintSize));
+
+	/// The size of a body's state, at its largest.
+	static constexpr uint8_t maximumBodySize = (4 * maximumVarintSize);
+
+	/// Gets the size of a frame that describes the specified number of bodies, at its largest.
+	static constexpr uint16_t getMaximumFrameSize(uint8_t bodyCount)
+	{
+		return (maximumHeaderSize + ((bodyCount + 7) / 8) + (bodyCount * maximumBodySize));
+	}
+};
+
+/// Streams the state of the world over serial, one frame per call to `record`.
+///
+/// Frames are written to a small ring buffer and sent a little at a time,
+/// no faster than the serial port can take them, so sending never blocks.
+/// If a frame doesn't fit in the buffer it's dropped,
+/// and the same bodies are sent again in the next frame, as a keyframe.
+///
+/// `Telemetry<false, capacity>` does nothing at all,
+/// so disabling telemetry removes its cost entirely.
+template< bool enabled, uint8_t capacity >
+class Telemetry;
+
+template< uint8_t capacity >
+class Telemetry<true, capacity>
+{
+public:
+	static constexpr bool isEnabled = true;
+
+	/// The size of the ring buffer, which must be a power of two.
+	static constexpr uint8_t bufferSize = 128;
+
+	/// The most bodies each frame describes.
+	static constexpr uint8_t bodiesPerFrame = (capacity < TelemetryFormat::maximumBodiesPerFrame) ? capacity : TelemetryFormat::maximumBodiesPerFrame;
+
+private:
+	static constexpr uint8_t bufferMask = (bufferSize - 1);
+
+	static_assert((bufferSize & bufferMask) == 0, "The buffer size must be a power of two");
+
+	// The buffer is full one byte before the head catches up with the tail
+	static_assert(TelemetryFormat::getMaximumFrameSize(bodiesPerFrame) < bufferSize, "A frame must always fit in an empty buffer");
+
+private:
+	uint8_t buffer[bufferSize];
+
+	/// The index of the next byte to be written.
+	uint8_t head = 0;
+
+	/// The index of the next byte to be sent.
+	uint8_t tail = 0;
+
+	/// The index of the next byte of the frame being written,
+	/// which only becomes part of the buffer once the frame is complete.
+	uint8_t frameHead = 0;
+
+	/// The sum of the frame's bytes so far.
+	uint8_t checksum = 0;
+
+	/// Indicates whether the frame being written has run out of room.
+	bool overflowed = false;
+
+	uint8_t sequence = 0;
+	uint8_t droppedFrames = 0;
+
+	/// The number of frames since the last round of keyframes started,
+	/// which starts at the interval so that the first round is keyframes.
+	uint8_t framesSinceKeyframe = TelemetryFormat::keyframeInterval;
+
+	/// The first body the next frame describes.
+	uint8_t nextBody = 0;
+
+	/// Indicates whether the current round over the bodies is keyframes.
+	bool keyframeRound = true;
+
+	/// Indicates whether the next frame is a keyframe regardless,
+	/// because the frame describing its bodies was dropped.
+	bool keyframeRetry = false;
+
+	/// The state sent in the last frame, that deltas are taken from.
+	uint8_t sentCount = 0;
+	uint16_t sentContactCount = 0;
+	int8_t sentX[capacity];
+	int8_t sentY[capacity];
+
+public:
+	/// Writes a frame describing the world, and the times the profiler took, to the buffer.
+	template< typename World, typename Profiler >
+	void record(const World & world, const Profiler & profiler, uint8_t steps)
+	{
+		const uint8_t count = world.getCount();
+
+		// If the bodies have changed, or every body has been described...
+		if((count != sentCount) || (nextBody >= count))
+			// Start a new round from the first body.
+			nextBody = 0;
+
+		// Each round decides whether it's keyframes as it starts.
+		if(nextBody == 0)
+			keyframeRound = ((framesSinceKeyframe >= TelemetryFormat::keyframeInterval) || (count != sentCount));
+
+		const bool keyframe = (keyframeRound || keyframeRetry);
+
+		const uint8_t first = nextBody;
+		const uint8_t remaining = (count - first);
+		const uint8_t described = (remaining < bodiesPerFrame) ? remaining : bodiesPerFrame;
+		const uint8_t end = (first + described);
+
+		// Reserve the sync and length bytes.
+		frameHead = head;
+		overflowed = false;
+
+		writeByte(TelemetryFormat::sync);
+		writeByte(0);
+
+		const uint8_t lengthIndex = ((head + 1) & bufferMask);
+		const uint8_t payloadStart = frameHead;
+
+		checksum = 0;
+
+		writeByte(sequence);
+		writeByte(keyframe ? TelemetryFormat::keyframeFlag : 0);
+		writeByte(droppedFrames);
+		writeVarint(*this, profiler.getFrameTime());
+
+		for(uint8_t stage = 0; stage < profileStageCount; ++stage)
+			writeVarint(*this, profiler.getStageTime(static_cast<ProfileStage>(stage)));
+
+		writeByte(steps);
+		writeVarint(*this, static_cast<uint16_t>(world.getContactCount() - sentContactCount));
+		writeByte(count);
+		writeByte(first);
+		writeByte(described);
+
+		// Write the sleeping bodies, eight to a byte.
+		for(uint8_t start = first; start < end; start += 8)
+		{
+			uint8_t mask = 0;
+
+			for(uint8_t index = start; (index < end) && (index < (start + 8)); ++index)
+				if(world.isSleeping(index))
+					mask |= (1 << (index - start));
+
+			writeByte(mask);
+		}
+
+		for(uint8_t index = first; index < end; ++index)
+		{
+			// Positions are sent as they're drawn.
+			const auto x = static_cast<int8_t>(world.getX(index));
+			const auto y = static_cast<int8_t>(world.getY(index));
+			const auto velocity = world.getVelocity(index);
+
+			writeVarint(*this, encodeZigzag(keyframe ? x : (x - sentX[index])));
+			writeVarint(*this, encodeZigzag(keyframe ? y : (y - sentY[index])));
+			writeVarint(*this, encodeZigzag(velocity.x.getInternal()));
+			writeVarint(*this, encodeZigzag(velocity.y.getInternal()));
+
+			// These are only kept if the frame is,
+			// otherwise the next frame describes the same bodies as a keyframe.
+			sentX[index] = x;
+			sentY[index] = y;
+		}
+
+		const uint8_t length = static_cast<uint8_t>((frameHead - payloadStart) & bufferMask);
+
+		writeByte(checksum);
+
+		// If the frame didn't fit...
+		if(overflowed)
+		{
+			// Drop it, and make sure the same bodies can be decoded on their own next time.
+			if(droppedFrames < UINT8_MAX)
+				++droppedFrames;
+
+			keyframeRetry = true;
+			return;
+		}
+
+		// Keep the frame.
+		buffer[lengthIndex] = length;
+		head = frameHead;
+
+		++sequence;
+		droppedFrames = 0;
+		framesSinceKeyframe = (keyframeRound && (first == 0)) ? 1 : (framesSinceKeyframe + 1);
+		keyframeRetry = false;
+		nextBody = end;
+		sentCount = count;
+		sentContactCount = world.getContactCount();
+	}
+
+	/// Sends as much of the buffer as the output can take without blocking.
+	void send(Print & output)
+	{
+		int available = output.availableForWrite();
+
+		while((available > 0) && (tail != head))
+		{
+			output.write(buffer[tail]);
+			tail = ((tail + 1) & bufferMask);
+			--available;
+		}
+	}
+
+	/// Adds a byte to the frame being written.
+	void writeByte(uint8_t value)
+	{
+		const uint8_t next = ((frameHead + 1) & bufferMask);
+
+		// The buffer is full when the head would catch up with the tail.
+		if(overflowed || (next == tail))
+		{
+			overflowed = true;
+			return;
+		}
+
+		buffer[frameHead] = value;
+		frameHead = next;
+		checksum += value;
+	}
+};
+
+template< uint8_t capacity >
+class Telemetry<false, capacity>
+{
+public:
+	static constexpr bool isEnabled = false;
+
+	template< typename World, typename Profiler >
+	void record(const World &, const Profiler &, uint8_t) {}
+
+	void send(Print &) {}
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+//
+//  Copyright (C) 2018-2021 Pharap (@Pharap)
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+/// Variable length numbers, for saves and telemetry.
+///
+/// A varint is a number written seven bits at a time, lowest first,
+/// with the top bit of each byte marking that more bytes follow,
+/// so numbers below 128 take a single byte.
+///
+/// Signed numbers are zigzag encoded first, mapping 0, -1, 1, -2... to 0, 1, 2, 3...,
+/// so that small negative numbers are small too.
+
+/// The most bytes a varint can take.
+constexpr uint8_t maximumVarintSize = 3;
+
+/// Zigzag encodes a signed number.
+constexpr uint16_t encodeZigzag(int16_t value)
+{
+	return static_cast<uint16_t>((static_cast<uint16_t>(value) << 1) ^ static_cast<uint16_t>(value >> 15));
+}
+
+/// Decodes a zigzag encoded number.
+constexpr int16_t decodeZigzag(uint16_t value)
+{
+	return static_cast<int16_t>((value >> 1) ^ static_cast<uint16_t>(-static_cast<int16_t>(value & 1)));
+}
+
+/// Writes a varint through any writer with a `writeByte` function.
+template< typename Writer >
+void writeVarint(Writer & writer, uint16_t value)
+{
+	while(value >= 0x80)
+	{
+		writer.writeByte(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+
+	writer.writeByte(static_cast<uint8_t>(value));
+}
+
+/// Reads a varint through any reader with a `readByte` function.
+template< typename Reader >
+uint16_t readVarint(Reader & reader)
+{
+	uint16_t value = 0;
+
+	for(uint8_t shift = 0; shift < 16; shift += 7)
+	{
+		const uint8_t byte = reader.readByte();
+
+		value |= (static_cast<uint16_t>(byte & 0x7F) << shift);
+
+		if((byte & 0x80) == 0)
+			break;
+	}
+
+	return value;
+}
\ No newline at end of file
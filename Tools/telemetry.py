@@ -0,0 +1,329 @@
+#!/usr/bin/env python3
+#
+#  Copyright (C) 2018-2021 Pharap (@Pharap)
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+#
+
+"""Decodes the telemetry streamed by Physix, and plots it.
+
+Build Physix with Game::telemetryEnabled set to true, then run:
+
+    telemetry.py /dev/ttyACM0          # plot a live stream (needs pyserial and matplotlib)
+    telemetry.py capture.bin --csv     # print a captured stream as CSV
+
+See Physix/Telemetry.h for the frame format.
+"""
+
+import argparse
+import sys
+
+SYNC = 0xA5
+KEYFRAME_FLAG = 0x01
+
+STAGES = ('input', 'physics', 'render', 'display')
+
+
+class Frame:
+	def __init__(self):
+		self.sequence = 0
+		self.keyframe = False
+		self.dropped = 0
+		self.frame_time = 0
+		self.stage_times = []
+		self.steps = 0
+		self.contacts = 0
+		self.first = 0
+		self.described = 0
+		self.sleeping = []
+		self.positions = []
+		self.velocities = []
+
+
+def decode_zigzag(value):
+	return (value >> 1) ^ -(value & 1)
+
+
+class Reader:
+	def __init__(self, data):
+		self.data = data
+		self.index = 0
+
+	def byte(self):
+		value = self.data[self.index]
+		self.index += 1
+		return value
+
+	def varint(self):
+		value = 0
+		shift = 0
+
+		while shift < 16:
+			byte = self.byte()
+			value |= (byte & 0x7F) << shift
+
+			if (byte & 0x80) == 0:
+				break
+
+			shift += 7
+
+		return value & 0xFFFF
+
+	def signed(self):
+		value = decode_zigzag(self.varint())
+		return value - 0x10000 if value >= 0x8000 else value
+
+
+class Decoder:
+	"""Splits a byte stream into frames, resynchronising after corruption.
+
+	Each frame only describes some of the bodies,
+	so the decoder keeps the last known state of every body,
+	and a body's position is None until a keyframe has described it.
+	"""
+
+	def __init__(self):
+		self.pending = bytearray()
+		self.positions = []
+		self.velocities = []
+		self.sleeping = []
+		self.sequence = None
+		self.corrupted = 0
+		self.lost = 0
+
+	def feed(self, data):
+		self.pending.extend(data)
+
+		while True:
+			start = self.pending.find(bytes([SYNC]))
+
+			if start < 0:
+				self.pending.clear()
+				return
+
+			del self.pending[:start]
+
+			# Wait for the length.
+			if len(self.pending) < 2:
+				return
+
+			length = self.pending[1]
+
+			# Wait for the rest of the frame.
+			if len(self.pending) < (length + 3):
+				return
+
+			payload = bytes(self.pending[2:length + 2])
+			checksum = self.pending[length + 2]
+
+			if (sum(payload) & 0xFF) != checksum:
+				# Not a real frame, so look for the next sync byte.
+				self.corrupted += 1
+				del self.pending[:1]
+				continue
+
+			del self.pending[:length + 3]
+
+			frame = self.decode(payload)
+
+			if frame is not None:
+				yield frame
+
+	def decode(self, payload):
+		reader = Reader(payload)
+		frame = Frame()
+
+		try:
+			frame.sequence = reader.byte()
+			frame.keyframe = (reader.byte() & KEYFRAME_FLAG) != 0
+			frame.dropped = reader.byte()
+			frame.frame_time = reader.varint()
+			frame.stage_times = [reader.varint() for _ in STAGES]
+			frame.steps = reader.byte()
+			frame.contacts = reader.varint()
+			count = reader.byte()
+			frame.first = reader.byte()
+			frame.described = reader.byte()
+
+			masks = [reader.byte() for _ in range((frame.described + 7) // 8)]
+			sleeping = [((masks[index // 8] >> (index % 8)) & 1) != 0 for index in range(frame.described)]
+
+			bodies = []
+
+			for _ in range(frame.described):
+				x = reader.signed()
+				y = reader.signed()
+				vx = reader.signed()
+				vy = reader.signed()
+				bodies.append(((x, y), (vx / 256, vy / 256)))
+		except IndexError:
+			self.corrupted += 1
+			return None
+
+		if (frame.first + frame.described) > count:
+			self.corrupted += 1
+			return None
+
+		if self.sequence is not None:
+			self.lost += (frame.sequence - self.sequence - 1) & 0xFF
+
+		self.sequence = frame.sequence
+
+		# The bodies have changed, so nothing known about them still holds.
+		if len(self.positions) != count:
+			self.positions = [None] * count
+			self.velocities = [(0, 0)] * count
+			self.sleeping = [False] * count
+
+		for offset, ((x, y), velocity) in enumerate(bodies):
+			index = frame.first + offset
+			position = self.positions[index]
+
+			# A delta can't be used until a keyframe has described the body.
+			if frame.keyframe:
+				self.positions[index] = (x, y)
+			elif position is not None:
+				self.positions[index] = (position[0] + x, position[1] + y)
+
+			self.velocities[index] = velocity
+			self.sleeping[index] = sleeping[offset]
+
+		frame.positions = list(self.positions)
+		frame.velocities = list(self.velocities)
+		frame.sleeping = list(self.sleeping)
+
+		return frame
+
+
+def open_source(name):
+	try:
+		return open(name, 'rb')
+	except OSError:
+		import serial
+		return serial.Serial(name, 9600, timeout=0.1)
+
+
+def read_frames(source, decoder):
+	while True:
+		data = source.read(256)
+
+		if not data:
+			# A file has ended, but a serial port may just be quiet.
+			if hasattr(source, 'in_waiting'):
+				continue
+
+			return
+
+		yield from decoder.feed(data)
+
+
+def print_csv(frames):
+	"""Prints a row for each body that each frame described."""
+
+	stages = ','.join(f'{stage}_time' for stage in STAGES)
+	print(f'sequence,frame_time,{stages},steps,contacts,dropped,body,x,y,vx,vy,sleeping')
+
+	for frame in frames:
+		times = ','.join(str(time) for time in frame.stage_times)
+
+		for index in range(frame.first, frame.first + frame.described):
+			position = frame.positions[index]
+
+			if position is None:
+				continue
+
+			(x, y) = position
+			(vx, vy) = frame.velocities[index]
+			print(f'{frame.sequence},{frame.frame_time},{times},{frame.steps},{frame.contacts},{frame.dropped},'
+				f'{index},{x},{y},{vx},{vy},{int(frame.sleeping[index])}')
+
+
+def plot(frames, history):
+	import collections
+	import matplotlib.pyplot as pyplot
+
+	figure, (scene, timing) = pyplot.subplots(1, 2, figsize=(12, 5))
+	frame_times = collections.deque(maxlen=history)
+	stage_times = [collections.deque(maxlen=history) for _ in STAGES]
+	contacts = collections.deque(maxlen=history)
+	trails = {}
+
+	pyplot.ion()
+
+	for frame in frames:
+		frame_times.append(frame.frame_time)
+		contacts.append(frame.contacts)
+
+		for times, time in zip(stage_times, frame.stage_times):
+			times.append(time)
+
+		for index in range(frame.first, frame.first + frame.described):
+			position = frame.positions[index]
+
+			if position is not None:
+				trails.setdefault(index, collections.deque(maxlen=history)).append(position)
+
+		# Redrawing is slow, so only draw every few frames.
+		if (frame.sequence % 10) != 0:
+			continue
+
+		scene.clear()
+		scene.set_xlim(0, 128)
+		scene.set_ylim(64, 0)
+		scene.set_aspect('equal')
+		scene.set_title('Bodies')
+
+		for index, trail in trails.items():
+			if index >= len(frame.positions):
+				continue
+
+			xs, ys = zip(*trail)
+			scene.plot(xs, ys, linewidth=0.5)
+			scene.plot(xs[-1], ys[-1], 'x' if frame.sleeping[index] else 'o')
+
+		timing.clear()
+		timing.set_title('Frame time (us) and contacts')
+		timing.plot(frame_times, label='frame time')
+
+		for stage, times in zip(STAGES, stage_times):
+			timing.plot(times, label=stage, linewidth=0.5)
+
+		timing.plot([count * 100 for count in contacts], label='contacts x 100')
+		timing.legend(loc='upper left')
+
+		pyplot.pause(0.001)
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+	parser.add_argument('source', help='a serial port, or a file holding a captured stream')
+	parser.add_argument('--csv', action='store_true', help='print the frames as CSV instead of plotting them')
+	parser.add_argument('--history', type=int, default=300, help='the number of frames to plot')
+	arguments = parser.parse_args()
+
+	decoder = Decoder()
+	frames = read_frames(open_source(arguments.source), decoder)
+
+	try:
+		if arguments.csv:
+			print_csv(frames)
+		else:
+			plot(frames, arguments.history)
+	except KeyboardInterrupt:
+		pass
+
+	print(f'{decoder.corrupted} corrupted frames, {decoder.lost} lost frames', file=sys.stderr)
+
+
+if __name__ == '__main__':
+	main()